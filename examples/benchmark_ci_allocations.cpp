@@ -0,0 +1,149 @@
+#include "statistic.h"
+#include "dataset.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <vector>
+
+/**
+ * @brief CI Test Allocation Benchmark
+ *
+ * Runs the regression CI test with |S| = 0..3 on a 10 000 row dataset, once through
+ * the design-matrix path (CITestMode::Regression) and once through the in-place
+ * Gram-matrix path (CITestMode::InPlace), in both Dataset storage modes.
+ * The heap allocator is replaced to count the bytes each test allocates.
+ *
+ * Expected output:
+ * - Bytes allocated per test (0 for the in-place path)
+ * - Time per test in microseconds
+ */
+
+namespace {
+std::atomic<size_t> g_allocatedBytes{ 0 };
+std::atomic<size_t> g_allocations{ 0 };
+
+void countAllocation(size_t size) {
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+}
+
+#if defined(__GLIBC__)
+// Eigen allocates through malloc rather than operator new, so on glibc the allocator
+// itself is interposed; operator new ends up here as well.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size) {
+    countAllocation(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    countAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    countAllocation(size);
+    return __libc_realloc(ptr, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    countAllocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size) {
+    countAllocation(size);
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr ? 0 : ENOMEM;
+}
+}
+#else
+// Elsewhere only operator new is counted, which misses Eigen's own heap buffers
+void* operator new(std::size_t size) {
+    countAllocation(size);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+#endif
+
+std::shared_ptr<Dataset> createDataset(size_t numRows, size_t numColumns, DatasetStorage storage) {
+    std::mt19937 rng(2025);
+    std::normal_distribution<double> noise(0.0, 1.0);
+
+    std::vector<Column> columns(numColumns, Column(numRows));
+    for (size_t r = 0; r < numRows; ++r) {
+        columns[0][r] = noise(rng);
+        for (size_t c = 1; c < numColumns; ++c) {
+            columns[c][r] = 0.5 * columns[c - 1][r] + noise(rng);
+        }
+    }
+    return std::make_shared<Dataset>(std::move(columns), storage);
+}
+
+void printSeparator() {
+    std::cout << std::string(70, '=') << "\n";
+}
+
+int main() {
+    printSeparator();
+    std::cout << "CI TEST ALLOCATION BENCHMARK\n";
+    printSeparator();
+
+    const size_t numRows = 10000;
+    const int repetitions = 200;
+    const std::vector<std::vector<int>> conditioningSets = { {}, { 2 }, { 2, 3 }, { 2, 3, 4 } };
+
+    for (auto storage : { DatasetStorage::Columns, DatasetStorage::Contiguous }) {
+        auto data = createDataset(numRows, 6, storage);
+        std::cout << "\nStorage: " << (storage == DatasetStorage::Columns ? "Columns" : "Contiguous") << "\n";
+        std::cout << std::setw(6) << "|S|" << std::setw(14) << "mode" << std::setw(18) << "bytes / test"
+                  << std::setw(16) << "allocs / test" << std::setw(14) << "us / test" << "\n";
+
+        for (const auto& conditioningSet : conditioningSets) {
+            for (auto mode : { CITestMode::Regression, CITestMode::InPlace }) {
+                double checksum = 0.0;
+                size_t bytesBefore = g_allocatedBytes;
+                size_t allocationsBefore = g_allocations;
+                auto start = std::chrono::high_resolution_clock::now();
+
+                for (int rep = 0; rep < repetitions; ++rep) {
+                    checksum += mode == CITestMode::InPlace
+                        ? Statistic::testConditionalIndependenceInPlace(*data, 0, 5, conditioningSet)
+                        : Statistic::testConditionalIndependence(data, 0, 5, conditioningSet);
+                }
+
+                auto end = std::chrono::high_resolution_clock::now();
+                double us = std::chrono::duration<double, std::micro>(end - start).count();
+                size_t bytes = g_allocatedBytes - bytesBefore;
+                size_t allocations = g_allocations - allocationsBefore;
+
+                std::cout << std::setw(6) << conditioningSet.size()
+                          << std::setw(14) << (mode == CITestMode::InPlace ? "InPlace" : "Regression")
+                          << std::setw(18) << bytes / repetitions
+                          << std::setw(16) << std::fixed << std::setprecision(1) << static_cast<double>(allocations) / repetitions
+                          << std::setw(14) << std::fixed << std::setprecision(1) << us / repetitions
+                          << (checksum < 0 ? " !" : "") << "\n";
+            }
+        }
+    }
+
+    printSeparator();
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include "ciTestCache.h"
+#include "residualCache.h"
+#include "threadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief CI Test Cache Throughput Benchmark
+ *
+ * Every CI test of a skeleton level looks up the p-value cache and the residual cache from
+ * whichever worker runs it. This runs the same lookup mix over 64 stored keys on both
+ * caches from 1, 2, 4 and 8 threads (up to the hardware's), each thread doing the same
+ * number of lookups, to show whether throughput grows with the threads or serializes on
+ * the caches' locks.
+ *
+ * Expected output:
+ * - Seconds per run and lookups per second for each thread count
+ * - Throughput relative to one thread (at most 1 with a single global lock)
+ */
+
+void printSeparator() {
+    std::cout << std::string(70, '=') << "\n";
+}
+
+int main() {
+    printSeparator();
+    std::cout << "CI TEST CACHE THROUGHPUT BENCHMARK\n";
+    printSeparator();
+
+    const int numKeys = 64;
+    const int lookupsPerThread = 200000;
+
+    auto residual = std::make_shared<ResidualStatistics>();
+    residual->coefficients = Eigen::VectorXd::Zero(2);
+
+    // Conditioning sets built up front, so the timed loop only looks up
+    std::vector<std::vector<int>> conditioningSets;
+    for (int v = 0; v < numKeys; ++v) {
+        conditioningSets.push_back({ v + 2 });
+    }
+
+    CITestCache pValues;
+    ResidualCache residuals;
+    for (int v = 0; v < numKeys; ++v) {
+        pValues.store(v, v + 1, conditioningSets[v], 0.5);
+        residuals.store(v, conditioningSets[v], residual);
+    }
+
+    size_t hardwareThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    std::cout << "Hardware threads: " << hardwareThreads << "\n\n";
+    std::cout << std::setw(10) << "threads" << std::setw(14) << "seconds" << std::setw(20) << "lookups / s"
+              << std::setw(14) << "speedup" << "\n";
+
+    double serialThroughput = 0.0;
+    for (size_t numThreads : { 1, 2, 4, 8 }) {
+        if (numThreads > 1 && numThreads > hardwareThreads) {
+            break;
+        }
+
+        ThreadPool pool(numThreads);
+        size_t found = 0;
+        std::vector<size_t> foundPerTask(numThreads, 0);
+        auto start = std::chrono::high_resolution_clock::now();
+
+        pool.parallelFor(numThreads, [&](size_t task) {
+            double p_value = 0.0;
+            size_t hits = 0;
+            for (int k = 0; k < lookupsPerThread; ++k) {
+                int v = static_cast<int>((task * 7 + k) % numKeys);
+                hits += pValues.lookup(v, v + 1, conditioningSets[v], p_value);
+                hits += residuals.lookup(v, conditioningSets[v]) != nullptr;
+            }
+            foundPerTask[task] = hits;
+        });
+
+        auto end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        for (size_t hits : foundPerTask) {
+            found += hits;
+        }
+
+        // Two lookups per iteration, one on each cache
+        double throughput = 2.0 * lookupsPerThread * numThreads / seconds;
+        if (numThreads == 1) {
+            serialThroughput = throughput;
+        }
+
+        std::cout << std::setw(10) << numThreads
+                  << std::setw(14) << std::fixed << std::setprecision(3) << seconds
+                  << std::setw(20) << std::fixed << std::setprecision(0) << throughput
+                  << std::setw(14) << std::fixed << std::setprecision(2) << throughput / serialThroughput
+                  << (found != 2 * lookupsPerThread * numThreads ? " !" : "") << "\n";
+    }
+
+    printSeparator();
+    return 0;
+}
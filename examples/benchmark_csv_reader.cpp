@@ -0,0 +1,172 @@
+#include "CSVReader.h"
+#include "datasetCache.h"
+#include "multiFileReader.h"
+#include <iostream>
+#include <chrono>
+#include <iomanip>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief CSV Loading Throughput Benchmark
+ *
+ * Compares the stream-based CSVReader::readCSVFile with the memory-mapped,
+ * multithreaded CSVReader::readCSVFileMapped on the same file, and with reopening
+ * a DatasetCache snapshot of it. Without arguments it also loads 4 of 40 columns
+ * by name with CSVReader::readCSVColumns, and the same rows split over three
+ * monthly files, one after the other and with MultiFileReader::readColumns.
+ *
+ * Usage:
+ *   benchmark_csv_reader                       (generates 463K rows x 4 columns)
+ *   benchmark_csv_reader <file.csv> <columns>  (e.g. the full vehicle export)
+ *
+ * Expected output:
+ * - Best-of-3 load time and throughput in MB/s for both readers
+ * - Whether both readers returned identical columns
+ * - Binary cache reload time (one mmap, no parsing)
+ * - Projection of a wide file: all 40 columns vs 4 selected by header name
+ * - Three monthly files loaded in turn vs concurrently, with per-file rows and times
+ */
+
+std::string generateFile(size_t numRows, int numColumns, const std::string& suffix = "") {
+    std::string name = "benchmark_csv_reader_" + std::to_string(numColumns) + suffix + ".csv";
+    std::string path = (std::filesystem::temp_directory_path() / name).string();
+    std::ofstream file(path);
+
+    std::mt19937 rng(463);
+    std::uniform_real_distribution<double> value(0.0, 5000.0);
+
+    for (int c = 0; c < numColumns; ++c) {
+        file << (c ? "," : "") << "col" << c;
+    }
+    file << "\n" << std::fixed << std::setprecision(3);
+
+    for (size_t r = 0; r < numRows; ++r) {
+        for (int c = 0; c < numColumns; ++c) {
+            file << (c ? "," : "") << value(rng);
+        }
+        file << "\n";
+    }
+
+    return path;
+}
+
+double bestOfThree(const std::function<void()>& load) {
+    double best = 0.0;
+    for (int run = 0; run < 3; ++run) {
+        auto start = std::chrono::high_resolution_clock::now();
+        load();
+        auto end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        best = run == 0 ? seconds : std::min(best, seconds);
+    }
+    return best;
+}
+
+void printSeparator() {
+    std::cout << std::string(70, '=') << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string path;
+    int numColumns = 4;
+
+    if (argc >= 3) {
+        path = argv[1];
+        numColumns = std::stoi(argv[2]);
+    }
+    else {
+        path = generateFile(463000, numColumns);
+    }
+
+    double megabytes = std::filesystem::file_size(path) / (1024.0 * 1024.0);
+
+    printSeparator();
+    std::cout << "CSV LOADING THROUGHPUT BENCHMARK\n";
+    printSeparator();
+    std::cout << "File: " << path << " (" << std::fixed << std::setprecision(1) << megabytes << " MB, "
+              << numColumns << " columns)\n\n";
+
+    std::vector<Column> streamColumns;
+    std::vector<Column> mappedColumns;
+
+    double streamSeconds = bestOfThree([&]() { streamColumns = CSVReader::readCSVFile(path, numColumns); });
+    double mappedSeconds = bestOfThree([&]() { mappedColumns = CSVReader::readCSVFileMapped(path, numColumns); });
+
+    std::cout << std::setw(24) << "reader" << std::setw(14) << "time [ms]" << std::setw(14) << "MB/s" << "\n";
+    std::cout << std::setw(24) << "readCSVFile" << std::setw(14) << std::setprecision(1) << streamSeconds * 1000.0
+              << std::setw(14) << megabytes / streamSeconds << "\n";
+    std::cout << std::setw(24) << "readCSVFileMapped" << std::setw(14) << mappedSeconds * 1000.0
+              << std::setw(14) << megabytes / mappedSeconds << "\n\n";
+
+    std::cout << "Rows loaded: " << (streamColumns.empty() ? 0 : streamColumns[0].size()) << "\n";
+    std::cout << "Speedup: " << std::setprecision(2) << streamSeconds / mappedSeconds << "x\n";
+    std::cout << "Identical columns: " << (streamColumns == mappedColumns ? "yes" : "NO") << "\n";
+
+    std::string cachePath = path + ".cache";
+    DatasetCache::save(cachePath, Dataset(mappedColumns));
+    std::shared_ptr<Dataset> cached;
+    double cacheSeconds = bestOfThree([&]() { cached = DatasetCache::load(cachePath); });
+
+    auto cachedView = cached->getColumnView(numColumns - 1);
+    std::cout << "\n" << std::setw(24) << "DatasetCache::load" << std::setw(14) << std::setprecision(3) << cacheSeconds * 1000.0
+              << std::setw(14) << std::setprecision(1) << megabytes / cacheSeconds << "\n";
+    std::cout << "Identical columns: " << (Column(cachedView.begin(), cachedView.end()) == mappedColumns.back() ? "yes" : "NO") << "\n";
+    std::filesystem::remove(cachePath);
+
+    if (argc < 3) {
+        const int wideColumns = 40;
+        std::string widePath = generateFile(100000, wideColumns);
+        double wideMegabytes = std::filesystem::file_size(widePath) / (1024.0 * 1024.0);
+
+        std::vector<std::string> selected = { "col3", "col11", "col17", "col29" };
+        std::vector<Column> allColumns;
+        std::vector<Column> projected;
+
+        double allSeconds = bestOfThree([&]() { allColumns = CSVReader::readCSVFileMapped(widePath, wideColumns); });
+        double projectedSeconds = bestOfThree([&]() { projected = CSVReader::readCSVColumns(widePath, selected); });
+
+        std::cout << "\nWide file: " << std::setprecision(1) << wideMegabytes << " MB, " << wideColumns << " columns\n";
+        std::cout << std::setw(24) << "all 40 columns" << std::setw(14) << allSeconds * 1000.0
+                  << std::setw(14) << wideMegabytes / allSeconds << "\n";
+        std::cout << std::setw(24) << "4 columns by name" << std::setw(14) << projectedSeconds * 1000.0
+                  << std::setw(14) << wideMegabytes / projectedSeconds << "\n";
+        std::cout << "Identical columns: " << (projected[2] == allColumns[17] ? "yes" : "NO") << "\n";
+
+        std::vector<std::string> months;
+        for (int month = 1; month <= 3; ++month) {
+            months.push_back(generateFile(463000 / 3, numColumns, "_20230" + std::to_string(month)));
+        }
+        std::vector<std::string> names = { "col0", "col1", "col2", "col3" };
+        std::vector<Column> sequential;
+        std::vector<Column> concurrent;
+        std::vector<FileLoadStats> stats;
+
+        double sequentialSeconds = bestOfThree([&]() {
+            sequential.assign(names.size(), Column());
+            for (const auto& month : months) {
+                auto part = CSVReader::readCSVColumns(month, names);
+                for (size_t c = 0; c < names.size(); ++c) {
+                    sequential[c].insert(sequential[c].end(), part[c].begin(), part[c].end());
+                }
+            }
+        });
+        double concurrentSeconds = bestOfThree([&]() { concurrent = MultiFileReader::readColumns(months, names, &stats); });
+
+        std::cout << "\nThree monthly files, " << concurrent[0].size() << " rows in total\n";
+        std::cout << std::setw(24) << "one after the other" << std::setw(14) << sequentialSeconds * 1000.0 << "\n";
+        std::cout << std::setw(24) << "MultiFileReader" << std::setw(14) << concurrentSeconds * 1000.0 << "\n";
+        for (const auto& file : stats) {
+            std::cout << std::setw(24) << std::filesystem::path(file.filename).filename().string()
+                      << std::setw(14) << file.milliseconds << std::setw(14) << file.numRows << " rows\n";
+        }
+        std::cout << "Identical columns: " << (sequential == concurrent ? "yes" : "NO") << "\n";
+    }
+
+    printSeparator();
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "correlationMatrix.h"
+#include "dataset.h"
+#include "statistic.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Partial Correlation Kernel Benchmark
+ *
+ * Times the partial correlation alone and one CI test per conditioning-set size |S| = 0..6
+ * in the covariance mode, where a test reads only the correlation matrix, and one in-place
+ * test on a 1 000 row dataset. The p-value (a Student t CDF) costs a few microseconds, so
+ * the first column isolates the kernel, and the decision column shows the covariance test
+ * comparing against a CriticalCorrelation instead.
+ * Sizes up to CorrelationMatrix::MaxFixedConditioning run the kernels specialized for their
+ * size; the larger ones show the generic dynamic-size fallback for comparison.
+ *
+ * Expected output:
+ * - Nanoseconds per partial correlation, covariance test (exact and decision only) and
+ *   in-place test for each |S|
+ * - Which kernel served the size
+ */
+
+std::vector<Column> generateColumns(size_t numRows, size_t numColumns) {
+    std::mt19937 rng(22);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::vector<Column> columns(numColumns, Column(numRows));
+    for (size_t r = 0; r < numRows; ++r) {
+        columns[0][r] = noise(rng);
+        for (size_t c = 1; c < numColumns; ++c) {
+            columns[c][r] = 0.5 * columns[c - 1][r] + noise(rng);
+        }
+    }
+    return columns;
+}
+
+// Keeps the compiler from discarding the timed calls
+volatile double g_sink = 0.0;
+
+template <typename Test>
+double nanosecondsPerTest(Test&& test, int repetitions) {
+    double sum = 0.0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int rep = 0; rep < repetitions; ++rep) {
+        sum += test();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    g_sink = sum;
+    return std::chrono::duration<double, std::nano>(end - start).count() / repetitions;
+}
+
+int main() {
+    const size_t numColumns = 9;
+    auto data = std::make_shared<Dataset>(generateColumns(1000, numColumns));
+    CorrelationMatrix correlations(*data);
+    CriticalCorrelation critical(0.05, CITestStatistic::TStatistic);
+
+    std::cout << std::string(70, '=') << "\n";
+    std::cout << "PARTIAL CORRELATION KERNEL BENCHMARK\n";
+    std::cout << std::string(70, '=') << "\n";
+    std::cout << std::setw(6) << "|S|" << std::setw(18) << "partial r [ns]" << std::setw(18) << "covariance [ns]" << std::setw(16) << "decision [ns]" << std::setw(18) << "in-place [ns]" << std::setw(14) << "kernel" << "\n";
+
+    for (int depth = 0; depth <= 6; ++depth) {
+        std::vector<int> conditioningSet;
+        for (int k = 0; k < depth; ++k) {
+            conditioningSet.push_back(2 + k);
+        }
+        int j = static_cast<int>(numColumns) - 1;
+
+        double kernelNanos = nanosecondsPerTest([&]() {
+            return correlations.partialCorrelation(0, j, conditioningSet);
+        }, 1000000);
+        double covarianceNanos = nanosecondsPerTest([&]() {
+            return Statistic::testConditionalIndependence(correlations, 0, j, conditioningSet);
+        }, 200000);
+        double decisionNanos = nanosecondsPerTest([&]() {
+            return Statistic::testConditionalIndependence(correlations, 0, j, conditioningSet, CITestStatistic::TStatistic, &critical);
+        }, 200000);
+        double inPlaceNanos = nanosecondsPerTest([&]() {
+            return Statistic::testConditionalIndependenceInPlace(*data, 0, j, conditioningSet);
+        }, 5000);
+
+        const char* kernel = depth == 0 ? "none" : depth == 1 ? "closed form" : depth <= CorrelationMatrix::MaxFixedConditioning ? "fixed size" : "generic";
+        std::cout << std::setw(6) << depth << std::fixed << std::setprecision(1) << std::setw(18) << kernelNanos << std::setw(18) << covarianceNanos << std::setw(16) << decisionNanos
+                  << std::setw(18) << inPlaceNanos << std::setw(14) << kernel << "\n";
+    }
+
+    std::cout << std::string(70, '=') << "\n";
+    return 0;
+}
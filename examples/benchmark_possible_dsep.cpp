@@ -0,0 +1,85 @@
+#include "possibleDSep.h"
+#include "graph.h"
+#include "dataset.h"
+#include <iostream>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Possible-D-Sep Scaling Benchmark
+ *
+ * Builds random sparse PAGs (average degree ~4, a third of the edges oriented)
+ * and computes Possible-D-Sep for every vertex with the reachability engine.
+ *
+ * Expected output:
+ * - Time per graph and per vertex for 50 to 1600 variables
+ * - Average Possible-D-Sep size
+ */
+
+std::shared_ptr<Graph> createRandomGraph(int numVertices, double averageDegree, std::mt19937& rng) {
+    auto graph = std::make_shared<Graph>(std::make_shared<Dataset>(std::vector<Column>(numVertices)));
+
+    std::uniform_int_distribution<int> vertex(0, numVertices - 1);
+    std::uniform_int_distribution<int> orientation(0, 2);
+
+    int numEdges = static_cast<int>(numVertices * averageDegree / 2);
+    for (int e = 0; e < numEdges; ++e) {
+        int a = vertex(rng);
+        int b = vertex(rng);
+        if (a == b || graph->hasDirectedEdge(a, b) || graph->hasDirectedEdge(b, a)) {
+            continue;
+        }
+
+        if (orientation(rng) == 0) {
+            graph->addDirectedEdge(a, b);
+        }
+        else {
+            graph->addDoubleDirectedEdge(a, b);
+        }
+    }
+
+    return graph;
+}
+
+void printSeparator() {
+    std::cout << std::string(70, '=') << "\n";
+}
+
+int main() {
+    printSeparator();
+    std::cout << "POSSIBLE-D-SEP SCALING BENCHMARK\n";
+    printSeparator();
+
+    std::mt19937 rng(2025);
+
+    std::cout << std::setw(10) << "vertices" << std::setw(16) << "total [ms]"
+              << std::setw(18) << "per vertex [us]" << std::setw(16) << "avg |PDS|" << "\n";
+
+    for (int numVertices : { 50, 100, 200, 400, 800, 1600 }) {
+        auto graph = createRandomGraph(numVertices, 4.0, rng);
+
+        auto start = std::chrono::high_resolution_clock::now();
+
+        PossibleDSep possibleDSep(*graph);
+        std::vector<int> result;
+        size_t totalSize = 0;
+        for (int x = 0; x < numVertices; ++x) {
+            possibleDSep.compute(x, result);
+            totalSize += result.size();
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+        std::cout << std::setw(10) << numVertices
+                  << std::setw(16) << std::fixed << std::setprecision(2) << ms
+                  << std::setw(18) << std::fixed << std::setprecision(2) << ms * 1000.0 / numVertices
+                  << std::setw(16) << std::fixed << std::setprecision(1) << static_cast<double>(totalSize) / numVertices << "\n";
+    }
+
+    printSeparator();
+    return 0;
+}
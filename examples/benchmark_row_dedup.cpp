@@ -0,0 +1,127 @@
+#include "CSVReader.h"
+#include "rowDeduplicator.h"
+#include "statistic.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Row Deduplication Benchmark
+ *
+ * Collapses repeated rows into weighted unique rows with RowDeduplicator and
+ * times the regression and in-place CI tests for |S| = 0..2 before and after.
+ * Without arguments it generates 463K rows drawn from 5 000 distinct specs, the
+ * way the vehicle registrations repeat across makes and models.
+ *
+ * Usage:
+ *   benchmark_row_dedup                          (synthetic 463K rows)
+ *   benchmark_row_dedup <file.csv> <c1> <c2> ... (named columns of a CSV file)
+ *
+ * Expected output:
+ * - Rows, distinct rows and deduplication time
+ * - Time per test for the raw and the deduplicated dataset, and the speedup
+ * - p-value on the raw rows and its difference after deduplication (round-off only)
+ */
+
+std::vector<Column> generateRows(size_t numRows, size_t numDistinct) {
+    std::mt19937 rng(463);
+    std::normal_distribution<double> noise(0.0, 1.0);
+
+    // Deviations from the fleet average: the regression test fits no intercept
+    std::vector<Column> specs(4, Column(numDistinct));
+    for (size_t d = 0; d < numDistinct; ++d) {
+        specs[0][d] = std::round(400 * noise(rng));                                // displacement
+        specs[1][d] = std::round(0.06 * specs[0][d] + 15 * noise(rng));            // power
+        specs[2][d] = std::round(0.1 * specs[1][d] + 2 * noise(rng));              // noise
+        specs[3][d] = std::round(0.5 * specs[1][d] + 0.02 * specs[0][d] + 10 * noise(rng)); // CO2
+    }
+
+    // Popular models account for most registrations
+    std::geometric_distribution<size_t> pick(10.0 / numDistinct);
+    std::vector<Column> columns(4, Column(numRows));
+    for (size_t r = 0; r < numRows; ++r) {
+        size_t d = std::min(pick(rng), numDistinct - 1);
+        for (size_t c = 0; c < 4; ++c) {
+            columns[c][r] = specs[c][d];
+        }
+    }
+    return columns;
+}
+
+template <typename Test>
+double microsecondsPerTest(Test&& test, int repetitions) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int rep = 0; rep < repetitions; ++rep) {
+        test();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / repetitions;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<Column> columns;
+    if (argc >= 4) {
+        columns = CSVReader::readCSVColumns(argv[1], std::vector<std::string>(argv + 2, argv + argc));
+    }
+    else {
+        columns = generateRows(463000, 5000);
+    }
+
+    auto data = std::make_shared<Dataset>(columns);
+    size_t numColumns = data->getNumOfColumns();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::shared_ptr<const Dataset> unique = RowDeduplicator::deduplicate(*data);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::cout << std::string(70, '=') << "\n";
+    std::cout << "ROW DEDUPLICATION BENCHMARK\n";
+    std::cout << std::string(70, '=') << "\n";
+    std::cout << "Rows: " << data->getColumnView(0).size() << ", distinct: " << unique->getColumnView(0).size()
+              << ", deduplicated in " << std::fixed << std::setprecision(1)
+              << std::chrono::duration<double, std::milli>(end - start).count() << " ms\n\n";
+
+    std::cout << std::setw(12) << "test" << std::setw(6) << "|S|" << std::setw(14) << "raw [us]"
+              << std::setw(14) << "dedup [us]" << std::setw(10) << "speedup" << std::setw(12) << "p" << std::setw(12) << "|dp|" << "\n";
+
+    // Column 2 depends on column 0 only through column 1 in the synthetic data, so the
+    // p-values range from 0 to well above alpha
+    int tested = numColumns > 2 ? 2 : 1;
+    std::vector<int> candidates;
+    for (int k = 1; k < static_cast<int>(numColumns); ++k) {
+        if (k != tested) {
+            candidates.push_back(k);
+        }
+    }
+
+    for (const char* mode : { "regression", "in-place" }) {
+        bool inPlace = std::string(mode) == "in-place";
+        for (size_t depth = 0; depth <= candidates.size() && depth <= 2; ++depth) {
+            std::vector<int> conditioningSet(candidates.begin(), candidates.begin() + depth);
+
+            double p_raw = 0.0;
+            double p_unique = 0.0;
+            auto run = [&](const std::shared_ptr<const Dataset>& d, double& p) {
+                p = inPlace ? Statistic::testConditionalIndependenceInPlace(*d, 0, tested, conditioningSet)
+                            : Statistic::testConditionalIndependence(d, 0, tested, conditioningSet);
+            };
+
+            double rawMicros = microsecondsPerTest([&]() { run(data, p_raw); }, 20);
+            double uniqueMicros = microsecondsPerTest([&]() { run(unique, p_unique); }, 200);
+
+            std::cout << std::setw(12) << mode << std::setw(6) << depth << std::setw(14) << std::setprecision(1) << rawMicros
+                      << std::setw(14) << uniqueMicros << std::setw(9) << rawMicros / uniqueMicros << "x"
+                      << std::scientific << std::setprecision(2) << std::setw(12) << p_raw << std::setw(12) << std::abs(p_raw - p_unique)
+                      << std::fixed << "\n";
+        }
+    }
+
+    std::cout << std::string(70, '=') << "\n";
+    return 0;
+}
@@ -1,7 +1,14 @@
 #include "CSVReader.h"
+#include "mappedFile.h"
+#include "threadPool.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <fstream>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
+#include <system_error>
 
 std::vector<Column> CSVReader::readCSVFile(const std::string& filename, int expectedColumnCount) {
     std::ifstream file(filename);
@@ -49,3 +56,234 @@ std::vector<Column> CSVReader::readCSVFile(const std::string& filename, int expe
     file.close();
     return columns;
 }
+
+namespace {
+
+// Chunks smaller than this are not worth a task of their own
+constexpr size_t MinChunkBytes = 64 * 1024;
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+// Parses one field the way std::stod does: leading whitespace and an optional '+'
+// are skipped, and anything after the number is ignored
+bool parseField(const char* first, const char* last, double& value) {
+    while (first < last && isSpace(*first)) {
+        ++first;
+    }
+    if (first < last && *first == '+') {
+        ++first;
+        if (first < last && *first == '-') {
+            return false;
+        }
+    }
+
+    auto result = std::from_chars(first, last, value);
+    return result.ec == std::errc();
+}
+
+// Fields are mapped to output columns by fieldColumns: field f goes to column fieldColumns[f],
+// or is skipped unparsed when that entry is -1. Fields after the last mapped one are never visited.
+// With MissingFields::KeepAsNaN a bad or absent mapped field becomes NaN instead of rejecting the line.
+bool parseLine(const char* first, const char* last, const std::vector<int>& fieldColumns, std::vector<Column>& columns, size_t row, MissingFields missing) {
+    bool keepMissing = missing == MissingFields::KeepAsNaN;
+    size_t numParsed = 0;
+
+    for (size_t f = 0; f < fieldColumns.size(); ++f) {
+        if (f > 0) {
+            if (first == last) {
+                if (!keepMissing) {
+                    return false;
+                }
+                for (; f < fieldColumns.size(); ++f) {
+                    if (fieldColumns[f] >= 0) {
+                        columns[fieldColumns[f]][row] = std::numeric_limits<double>::quiet_NaN();
+                    }
+                }
+                break;
+            }
+            ++first; // comma
+        }
+
+        const char* fieldEnd = static_cast<const char*>(std::memchr(first, ',', last - first));
+        if (!fieldEnd) {
+            fieldEnd = last;
+        }
+
+        if (fieldColumns[f] >= 0) {
+            double& value = columns[fieldColumns[f]][row];
+            if (parseField(first, fieldEnd, value)) {
+                ++numParsed;
+            }
+            else if (keepMissing) {
+                value = std::numeric_limits<double>::quiet_NaN();
+            }
+            else {
+                return false;
+            }
+        }
+        first = fieldEnd;
+    }
+
+    return !keepMissing || numParsed > 0;
+}
+
+// Parses [begin, end) into numColumns columns; rows where a mapped field is missing or not a number
+// are dropped, or kept with NaN in that field as missing says
+std::vector<Column> parseRows(const char* begin, const char* end, const std::vector<int>& fieldColumns, size_t numColumns, size_t numThreads,
+    MissingFields missing = MissingFields::DropRow) {
+    size_t numBytes = end - begin;
+    ThreadPool pool(numThreads);
+
+    // Cut the text into chunks that start right after a newline
+    size_t numChunks = std::max<size_t>(1, std::min(pool.getNumThreads() * 4, numBytes / MinChunkBytes));
+    std::vector<const char*> bounds(numChunks + 1, end);
+    bounds[0] = begin;
+    for (size_t k = 1; k < numChunks; ++k) {
+        const char* cut = std::max(begin + numBytes / numChunks * k, bounds[k - 1]);
+        const char* newline = static_cast<const char*>(std::memchr(cut, '\n', end - cut));
+        bounds[k] = newline ? newline + 1 : end;
+    }
+
+    // Pass 1: count lines to reserve each chunk a row range in the preallocated columns
+    std::vector<size_t> firstRow(numChunks + 1, 0);
+    pool.parallelFor(numChunks, [&](size_t k) {
+        size_t lines = std::count(bounds[k], bounds[k + 1], '\n');
+        if (bounds[k] < bounds[k + 1] && bounds[k + 1][-1] != '\n') {
+            ++lines;
+        }
+        firstRow[k + 1] = lines;
+    });
+    for (size_t k = 0; k < numChunks; ++k) {
+        firstRow[k + 1] += firstRow[k];
+    }
+
+    std::vector<Column> columns(numColumns, Column(firstRow[numChunks]));
+
+    // Pass 2: parse every chunk into its own row range; invalid lines are overwritten by the next one
+    std::vector<size_t> validRows(numChunks, 0);
+    pool.parallelFor(numChunks, [&](size_t k) {
+        size_t row = firstRow[k];
+        const char* line = bounds[k];
+        while (line < bounds[k + 1]) {
+            const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', bounds[k + 1] - line));
+            if (!lineEnd) {
+                lineEnd = bounds[k + 1];
+            }
+
+            if (parseLine(line, lineEnd, fieldColumns, columns, row, missing)) {
+                ++row;
+            }
+            if (lineEnd == bounds[k + 1]) {
+                break;
+            }
+            line = lineEnd + 1;
+        }
+        validRows[k] = row - firstRow[k];
+    });
+
+    // Close the gaps left by dropped lines
+    size_t numRows = validRows[0];
+    for (size_t k = 1; k < numChunks; ++k) {
+        if (firstRow[k] != numRows) {
+            for (Column& column : columns) {
+                std::copy(column.begin() + firstRow[k], column.begin() + firstRow[k] + validRows[k], column.begin() + numRows);
+            }
+        }
+        numRows += validRows[k];
+    }
+    for (Column& column : columns) {
+        column.resize(numRows);
+    }
+
+    return columns;
+}
+
+// Splits the header line into names without surrounding whitespace, quotes or a UTF-8 byte order mark
+std::vector<std::string> parseHeader(const char* first, const char* last) {
+    if (last - first >= 3 && std::memcmp(first, "\xEF\xBB\xBF", 3) == 0) {
+        first += 3;
+    }
+
+    std::vector<std::string> names;
+    while (true) {
+        const char* fieldEnd = static_cast<const char*>(std::memchr(first, ',', last - first));
+        if (!fieldEnd) {
+            fieldEnd = last;
+        }
+
+        const char* nameBegin = first;
+        const char* nameEnd = fieldEnd;
+        while (nameBegin < nameEnd && isSpace(*nameBegin)) {
+            ++nameBegin;
+        }
+        while (nameEnd > nameBegin && isSpace(nameEnd[-1])) {
+            --nameEnd;
+        }
+        if (nameEnd - nameBegin >= 2 && *nameBegin == '"' && nameEnd[-1] == '"') {
+            ++nameBegin;
+            --nameEnd;
+        }
+        names.emplace_back(nameBegin, nameEnd);
+
+        if (fieldEnd == last) {
+            return names;
+        }
+        first = fieldEnd + 1;
+    }
+}
+
+} // namespace
+
+std::vector<Column> CSVReader::readCSVFileMapped(const std::string& filename, int expectedColumnCount, size_t numThreads) {
+    if (expectedColumnCount < 0) {
+        throw std::invalid_argument("Expected column count cannot be negative.");
+    }
+
+    MappedFile file(filename);
+
+    std::vector<int> fieldColumns(expectedColumnCount);
+    for (int i = 0; i < expectedColumnCount; ++i) {
+        fieldColumns[i] = i;
+    }
+
+    return parseRows(file.data(), file.data() + file.size(), fieldColumns, expectedColumnCount, numThreads);
+}
+
+std::vector<Column> CSVReader::readCSVColumns(const std::string& filename, const std::vector<std::string>& columnNames, size_t numThreads, MissingFields missing) {
+    MappedFile file(filename);
+    const char* begin = file.data();
+    const char* end = begin + file.size();
+
+    if (file.size() == 0) {
+        throw std::invalid_argument("The file has no header: " + filename);
+    }
+
+    const char* headerEnd = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+    if (!headerEnd) {
+        headerEnd = end;
+    }
+    std::vector<std::string> header = parseHeader(begin, headerEnd);
+
+    // Only fields up to the last selected one are scanned; the rest of each line is never touched
+    std::vector<int> fieldColumns;
+    for (size_t c = 0; c < columnNames.size(); ++c) {
+        auto match = std::find(header.begin(), header.end(), columnNames[c]);
+        if (match == header.end()) {
+            throw std::invalid_argument("Column not found in " + filename + ": " + columnNames[c]);
+        }
+
+        size_t field = match - header.begin();
+        if (field >= fieldColumns.size()) {
+            fieldColumns.resize(field + 1, -1);
+        }
+        if (fieldColumns[field] >= 0) {
+            throw std::invalid_argument("Column selected more than once: " + columnNames[c]);
+        }
+        fieldColumns[field] = static_cast<int>(c);
+    }
+
+    const char* body = headerEnd < end ? headerEnd + 1 : end;
+    return parseRows(body, end, fieldColumns, columnNames.size(), numThreads, missing);
+}
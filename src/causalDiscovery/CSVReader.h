@@ -1,13 +1,32 @@
 #ifndef CSVREADER_H
 #define CSVREADER_H
 
+#include <cstddef>
 #include <vector>
 #include <string>
 #include "dataset.h"
 
+// What the column readers do with a row in which a selected field is empty or not a number
+enum class MissingFields {
+    DropRow,  // skip the row
+    KeepAsNaN // keep the row with NaN in that column; rows with no number at all are still skipped
+};
+
 class CSVReader {
 public:
     static std::vector<Column> readCSVFile(const std::string& filename, int expectedColumnCount);
+
+    // Same rows as readCSVFile, but the file is memory-mapped, split into newline-aligned
+    // chunks and parsed in parallel with std::from_chars straight into the columns.
+    // numThreads == 0 uses every hardware thread.
+    static std::vector<Column> readCSVFileMapped(const std::string& filename, int expectedColumnCount, size_t numThreads = 0);
+
+    // Loads the named columns, in the order given, from a file whose first line is a header.
+    // Unselected fields are skipped without being parsed; a row is dropped only if one of the
+    // selected fields is missing or not a number, unless missing says to keep it with NaN.
+    // Throws std::invalid_argument for unknown names.
+    static std::vector<Column> readCSVColumns(const std::string& filename, const std::vector<std::string>& columnNames, size_t numThreads = 0,
+        MissingFields missing = MissingFields::DropRow);
 };
 
 #endif // CSVREADER_H
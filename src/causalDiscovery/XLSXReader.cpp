@@ -0,0 +1,314 @@
+#include "XLSXReader.h"
+#include "zipArchive.h"
+#include "pugixml.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+
+namespace {
+
+constexpr size_t ChunkBytes = 64 * 1024;
+
+// Cuts the elements named tag out of an XML entry as it is inflated, one at a time.
+// Each element is handed out as its own small document, so the entry is never parsed whole.
+// The elements must not nest, which holds for <row> in a worksheet and <si> in shared strings.
+class ElementStream {
+public:
+    ElementStream(std::unique_ptr<ZipArchive::EntryReader> reader, const std::string& tag)
+        : m_reader(std::move(reader)), m_open("<" + tag), m_close("</" + tag + ">") {
+    }
+
+    // The view stays valid until the next call
+    bool next(std::string_view& element) {
+        while (true) {
+            size_t start = findOpeningTag();
+            if (start != std::string::npos) {
+                size_t end = findElementEnd(start);
+                if (end != std::string::npos) {
+                    element = std::string_view(m_buffer).substr(start, end - start);
+                    m_position = end;
+                    return true;
+                }
+                m_position = start;
+            }
+            else {
+                // Keep a tail that could hold the start of a tag cut by the chunk boundary
+                m_position = std::max(m_position, m_buffer.size() > m_open.size() ? m_buffer.size() - m_open.size() : 0);
+            }
+
+            if (!refill()) {
+                return false;
+            }
+        }
+    }
+
+private:
+    size_t findOpeningTag() const {
+        size_t pos = m_position;
+        while ((pos = m_buffer.find(m_open, pos)) != std::string::npos) {
+            size_t after = pos + m_open.size();
+            if (after >= m_buffer.size()) {
+                return std::string::npos;
+            }
+            char c = m_buffer[after];
+            if (c == '>' || c == '/' || c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+                return pos;
+            }
+            pos = after; // e.g. <rowBreaks> when looking for <row>
+        }
+        return std::string::npos;
+    }
+
+    size_t findElementEnd(size_t start) const {
+        size_t tagEnd = m_buffer.find('>', start);
+        if (tagEnd == std::string::npos) {
+            return std::string::npos;
+        }
+        if (m_buffer[tagEnd - 1] == '/') {
+            return tagEnd + 1;
+        }
+        size_t close = m_buffer.find(m_close, tagEnd);
+        return close == std::string::npos ? std::string::npos : close + m_close.size();
+    }
+
+    bool refill() {
+        m_buffer.erase(0, m_position);
+        m_position = 0;
+
+        size_t filled = m_buffer.size();
+        m_buffer.resize(filled + ChunkBytes);
+        size_t count = m_reader->read(m_buffer.data() + filled, ChunkBytes);
+        m_buffer.resize(filled + count);
+        return count > 0;
+    }
+
+    std::unique_ptr<ZipArchive::EntryReader> m_reader;
+    std::string m_open;
+    std::string m_close;
+    std::string m_buffer;
+    size_t m_position = 0;
+};
+
+// Replaces the contents of doc, which is reused from one fragment to the next
+void parseDocument(pugi::xml_document& doc, std::string_view xml, const std::string& what) {
+    if (!doc.load_buffer(xml.data(), xml.size())) {
+        throw std::runtime_error("Malformed XML in " + what);
+    }
+}
+
+// "A1" -> 0, "AB12" -> 27; -1 if the reference has no column letters
+int columnIndex(const char* reference) {
+    int column = 0;
+    const char* p = reference;
+    for (; *p >= 'A' && *p <= 'Z'; ++p) {
+        column = column * 26 + (*p - 'A' + 1);
+    }
+    return p == reference ? -1 : column - 1;
+}
+
+std::string_view trim(std::string_view text) {
+    size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    size_t last = text.find_last_not_of(" \t\r\n");
+    return text.substr(first, last - first + 1);
+}
+
+// Plain and rich-text runs of a shared or inline string
+std::string stringItemText(const pugi::xml_node& item) {
+    std::string text = item.child_value("t");
+    for (pugi::xml_node run : item.children("r")) {
+        text += run.child_value("t");
+    }
+    return text;
+}
+
+bool cellNumber(const pugi::xml_node& cell, double& value) {
+    std::string_view type = cell.attribute("t").value();
+    if (!type.empty() && type != "n" && type != "b") {
+        return false;
+    }
+
+    const char* text = cell.child_value("v");
+    const char* end = text + std::strlen(text);
+    double number;
+    auto [ptr, ec] = std::from_chars(text, end, number);
+    if (ec != std::errc() || ptr != end || ptr == text) {
+        return false;
+    }
+    value = number;
+    return true;
+}
+
+std::string cellText(const pugi::xml_node& cell, const std::vector<std::string>& sharedStrings) {
+    std::string_view type = cell.attribute("t").value();
+    if (type == "inlineStr") {
+        return stringItemText(cell.child("is"));
+    }
+
+    const char* value = cell.child_value("v");
+    if (type == "s") {
+        size_t index = 0;
+        auto [ptr, ec] = std::from_chars(value, value + std::strlen(value), index);
+        return ec == std::errc() && index < sharedStrings.size() ? sharedStrings[index] : std::string();
+    }
+    return value;
+}
+
+// Visits the cells of one <row> element with their zero-based column index
+template <typename Visitor>
+void forEachCell(pugi::xml_document& doc, std::string_view row, Visitor&& visit) {
+    parseDocument(doc, row, "worksheet row");
+    int nextColumn = 0;
+    for (pugi::xml_node cell : doc.child("row").children("c")) {
+        int column = columnIndex(cell.attribute("r").value());
+        if (column < 0) {
+            column = nextColumn; // the reference is optional for consecutive cells
+        }
+        nextColumn = column + 1;
+        if (!visit(column, cell)) {
+            return;
+        }
+    }
+}
+
+// Entry paths of a relationship target; targets are relative to xl/ unless absolute
+std::string resolveTarget(const std::string& target) {
+    return target.starts_with("/") ? target.substr(1) : "xl/" + target;
+}
+
+} // namespace
+
+std::vector<Column> XLSXReader::readXLSXColumns(const std::string& filename, const std::vector<std::string>& columnNames, const std::string& sheetName,
+    MissingFields missing) {
+    for (size_t c = 0; c < columnNames.size(); ++c) {
+        if (std::find(columnNames.begin(), columnNames.begin() + c, columnNames[c]) != columnNames.begin() + c) {
+            throw std::invalid_argument("Column selected more than once: " + columnNames[c]);
+        }
+    }
+
+    ZipArchive archive(filename);
+    if (!archive.findEntry("xl/workbook.xml") || !archive.findEntry("xl/_rels/workbook.xml.rels")) {
+        throw std::runtime_error("Not an XLSX workbook: " + filename);
+    }
+
+    // The workbook and its relationships are small; the sheet is reached through them
+    pugi::xml_document workbook;
+    std::string workbookXml = archive.readEntry("xl/workbook.xml");
+    parseDocument(workbook, workbookXml, filename);
+    std::string sheetId;
+    for (pugi::xml_node sheet : workbook.child("workbook").child("sheets").children("sheet")) {
+        if (sheetName.empty() || sheetName == sheet.attribute("name").value()) {
+            sheetId = sheet.attribute("r:id").value();
+            break;
+        }
+    }
+    if (sheetId.empty()) {
+        throw std::invalid_argument("Worksheet not found in " + filename + ": " + (sheetName.empty() ? "(first)" : sheetName));
+    }
+
+    pugi::xml_document relationships;
+    std::string relationshipsXml = archive.readEntry("xl/_rels/workbook.xml.rels");
+    parseDocument(relationships, relationshipsXml, filename);
+    std::string sheetPath;
+    std::string sharedStringsPath;
+    for (pugi::xml_node relationship : relationships.child("Relationships").children("Relationship")) {
+        std::string_view type = relationship.attribute("Type").value();
+        if (sheetId == relationship.attribute("Id").value()) {
+            sheetPath = resolveTarget(relationship.attribute("Target").value());
+        }
+        else if (type.ends_with("/sharedStrings")) {
+            sharedStringsPath = resolveTarget(relationship.attribute("Target").value());
+        }
+    }
+    if (sheetPath.empty() || !archive.findEntry(sheetPath)) {
+        throw std::runtime_error("Worksheet data missing from " + filename);
+    }
+
+    pugi::xml_document fragment;
+    std::vector<std::string> sharedStrings;
+    if (!sharedStringsPath.empty() && archive.findEntry(sharedStringsPath)) {
+        ElementStream items(archive.open(sharedStringsPath), "si");
+        std::string_view item;
+        while (items.next(item)) {
+            parseDocument(fragment, item, "shared strings");
+            sharedStrings.push_back(stringItemText(fragment.child("si")));
+        }
+    }
+
+    ElementStream rows(archive.open(sheetPath), "row");
+    std::string_view row;
+
+    // Header: the first row in which every requested name appears
+    std::vector<int> fieldColumns; // sheet column -> selected column, -1 if unselected
+    std::string missingName = columnNames.empty() ? std::string() : columnNames[0];
+    size_t bestMatches = 0;
+    bool headerFound = columnNames.empty();
+    while (!headerFound && rows.next(row)) {
+        std::vector<int> candidate;
+        size_t matches = 0;
+        forEachCell(fragment, row, [&](int column, const pugi::xml_node& cell) {
+            std::string text = cellText(cell, sharedStrings);
+            auto match = std::find(columnNames.begin(), columnNames.end(), trim(text));
+            if (match != columnNames.end()) {
+                if (column >= static_cast<int>(candidate.size())) {
+                    candidate.resize(column + 1, -1);
+                }
+                int selected = static_cast<int>(match - columnNames.begin());
+                if (std::find(candidate.begin(), candidate.end(), selected) == candidate.end()) {
+                    candidate[column] = selected;
+                    ++matches;
+                }
+            }
+            return true;
+        });
+
+        if (matches == columnNames.size()) {
+            fieldColumns = std::move(candidate);
+            headerFound = true;
+        }
+        else if (matches >= bestMatches) {
+            bestMatches = matches;
+            for (size_t c = 0; c < columnNames.size(); ++c) {
+                if (std::find(candidate.begin(), candidate.end(), static_cast<int>(c)) == candidate.end()) {
+                    missingName = columnNames[c];
+                    break;
+                }
+            }
+        }
+    }
+    if (!headerFound) {
+        throw std::invalid_argument("Column not found in " + filename + ": " + missingName);
+    }
+
+    std::vector<Column> columns(columnNames.size());
+    std::vector<double> values(columnNames.size());
+    while (!columnNames.empty() && rows.next(row)) {
+        std::fill(values.begin(), values.end(), std::numeric_limits<double>::quiet_NaN());
+        size_t numbers = 0;
+        forEachCell(fragment, row, [&](int column, const pugi::xml_node& cell) {
+            if (column >= static_cast<int>(fieldColumns.size())) {
+                return false; // past the last selected column
+            }
+            int selected = fieldColumns[column];
+            if (selected >= 0 && cellNumber(cell, values[selected])) {
+                ++numbers;
+            }
+            return true;
+        });
+
+        if (numbers == columnNames.size() || (missing == MissingFields::KeepAsNaN && numbers > 0)) {
+            for (size_t c = 0; c < columns.size(); ++c) {
+                columns[c].push_back(values[c]);
+            }
+        }
+    }
+
+    return columns;
+}
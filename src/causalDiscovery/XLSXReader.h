@@ -0,0 +1,21 @@
+#ifndef XLSXREADER_H
+#define XLSXREADER_H
+
+#include <string>
+#include <vector>
+#include "CSVReader.h"
+#include "dataset.h"
+
+class XLSXReader {
+public:
+    // Loads the named columns, in the order given, from one worksheet of an .xlsx workbook.
+    // The header is the first row holding every requested name, so title rows above it are
+    // skipped. As in CSVReader::readCSVColumns, a row is kept only if all selected cells are
+    // numbers, or with MissingFields::KeepAsNaN if any of them is. The sheet is inflated and parsed one row at a time and never held as a whole,
+    // so memory stays bounded by a row, not by the sheet. An empty sheetName reads the first
+    // worksheet. Throws std::invalid_argument for unknown or repeated column names.
+    static std::vector<Column> readXLSXColumns(const std::string& filename, const std::vector<std::string>& columnNames, const std::string& sheetName = "",
+        MissingFields missing = MissingFields::DropRow);
+};
+
+#endif // XLSXREADER_H
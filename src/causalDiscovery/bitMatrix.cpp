@@ -0,0 +1,102 @@
+#include "bitMatrix.h"
+#include <bit>
+#include <cstddef>
+#include <span>
+
+BitMatrix::RowRange::Iterator::Iterator(const Word* words, size_t numWords, size_t wordIndex)
+    : m_words(words), m_numWords(numWords), m_wordIndex(wordIndex) {
+    if (m_wordIndex < m_numWords) {
+        m_current = m_words[m_wordIndex];
+        skipEmptyWords();
+    }
+}
+
+void BitMatrix::RowRange::Iterator::skipEmptyWords() {
+    while (m_current == 0 && ++m_wordIndex < m_numWords) {
+        m_current = m_words[m_wordIndex];
+    }
+}
+
+int BitMatrix::RowRange::Iterator::operator*() const {
+    return static_cast<int>(m_wordIndex * WordBits + std::countr_zero(m_current));
+}
+
+BitMatrix::RowRange::Iterator& BitMatrix::RowRange::Iterator::operator++() {
+    // Drop the lowest set bit, then move on to the next non-empty word
+    m_current &= m_current - 1;
+    skipEmptyWords();
+    return *this;
+}
+
+BitMatrix::RowRange::Iterator BitMatrix::RowRange::Iterator::operator++(int) {
+    Iterator previous = *this;
+    ++*this;
+    return previous;
+}
+
+bool BitMatrix::RowRange::Iterator::operator==(const Iterator& other) const {
+    return m_wordIndex == other.m_wordIndex && m_current == other.m_current;
+}
+
+BitMatrix::RowRange::RowRange(std::span<const Word> words) : m_words(words) {
+}
+
+BitMatrix::RowRange::Iterator BitMatrix::RowRange::begin() const {
+    return Iterator(m_words.data(), m_words.size(), 0);
+}
+
+BitMatrix::RowRange::Iterator BitMatrix::RowRange::end() const {
+    return Iterator(m_words.data(), m_words.size(), m_words.size());
+}
+
+BitMatrix::BitMatrix(size_t size) {
+    reset(size);
+}
+
+void BitMatrix::reset(size_t size) {
+    m_size = size;
+    m_wordsPerRow = (size + WordBits - 1) / WordBits;
+    m_words.assign(m_size * m_wordsPerRow, 0);
+}
+
+size_t BitMatrix::size() const {
+    return m_size;
+}
+
+bool BitMatrix::test(size_t row, size_t col) const {
+    return (m_words[row * m_wordsPerRow + col / WordBits] >> (col % WordBits)) & 1;
+}
+
+void BitMatrix::set(size_t row, size_t col) {
+    m_words[row * m_wordsPerRow + col / WordBits] |= Word(1) << (col % WordBits);
+}
+
+void BitMatrix::clear(size_t row, size_t col) {
+    m_words[row * m_wordsPerRow + col / WordBits] &= ~(Word(1) << (col % WordBits));
+}
+
+size_t BitMatrix::count(size_t row) const {
+    size_t total = 0;
+    for (Word word : this->row(row)) {
+        total += std::popcount(word);
+    }
+    return total;
+}
+
+std::span<const BitMatrix::Word> BitMatrix::row(size_t row) const {
+    return std::span<const Word>(m_words.data() + row * m_wordsPerRow, m_wordsPerRow);
+}
+
+BitMatrix::RowRange BitMatrix::setBits(size_t row) const {
+    return RowRange(this->row(row));
+}
+
+BitMatrix BitMatrix::symmetrized() const {
+    BitMatrix result = *this;
+    for (size_t r = 0; r < m_size; ++r) {
+        for (int c : setBits(r)) {
+            result.set(c, r);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,86 @@
+#ifndef BITMATRIX_H
+#define BITMATRIX_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <vector>
+
+// Square n x n matrix of bits, one row per vertex. Each row occupies whole 64-bit
+// words, so a dense graph of 4096 vertices needs 2 MB and a row scan touches
+// n / 64 words. Rows can be iterated by set bits without allocating.
+class BitMatrix {
+public:
+    using Word = uint64_t;
+    static constexpr size_t WordBits = 64;
+
+    // Forward range over the set bits of one row, in ascending order
+    class RowRange {
+    public:
+        class Iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = int;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const int*;
+            using reference = int;
+
+            Iterator() = default;
+            Iterator(const Word* words, size_t numWords, size_t wordIndex);
+
+            int operator*() const;
+            Iterator& operator++();
+            Iterator operator++(int);
+
+            bool operator==(const Iterator& other) const;
+
+        private:
+            void skipEmptyWords();
+
+            const Word* m_words = nullptr;
+            size_t m_numWords = 0;
+            size_t m_wordIndex = 0;
+            Word m_current = 0;
+        };
+
+        explicit RowRange(std::span<const Word> words);
+
+        Iterator begin() const;
+        Iterator end() const;
+
+    private:
+        std::span<const Word> m_words;
+    };
+
+    BitMatrix() = default;
+    explicit BitMatrix(size_t size);
+
+    // Resizes to size x size and clears every bit
+    void reset(size_t size);
+
+    size_t size() const;
+
+    bool test(size_t row, size_t col) const;
+    void set(size_t row, size_t col);
+    void clear(size_t row, size_t col);
+
+    // Number of set bits in a row
+    size_t count(size_t row) const;
+
+    std::span<const Word> row(size_t row) const;
+    RowRange setBits(size_t row) const;
+
+    // Bitwise OR with the transpose; turns a directed adjacency into a symmetric one
+    BitMatrix symmetrized() const;
+
+    friend bool operator==(const BitMatrix& lhs, const BitMatrix& rhs) = default;
+
+private:
+    size_t m_size = 0;
+    size_t m_wordsPerRow = 0;
+    std::vector<Word> m_words;
+};
+
+#endif // BITMATRIX_H
@@ -2,11 +2,103 @@
 #include "statistic.h"
 #include "graph.h"
 #include "dataset.h"
+#include "threadPool.h"
+#include "possibleDSep.h"
+#include "combinationGenerator.h"
+#include "bitMatrix.h"
+#include <algorithm>
 #include <memory>
-#include <stack>
+#include <optional>
 #include <set>
+#include <span>
 #include <stdexcept>
 #include <iostream>
+#include <vector>
+
+void CausalDiscovery::setCITestMode(CITestMode mode)
+{
+    m_ciTestMode = mode;
+}
+
+void CausalDiscovery::setCITestStatistic(CITestStatistic statistic)
+{
+    m_ciTestStatistic = statistic;
+}
+
+void CausalDiscovery::setMissingValues(MissingValues missingValues)
+{
+    m_missingValues = missingValues;
+}
+
+void CausalDiscovery::setNumThreads(size_t numThreads)
+{
+    m_numThreads = numThreads;
+}
+
+void CausalDiscovery::setMaxConditioningDepth(int maxDepth)
+{
+    if (maxDepth < -1)
+    {
+        throw std::invalid_argument("Maximum conditioning depth must be -1 (unlimited) or non-negative.");
+    }
+
+    m_maxConditioningDepth = maxDepth;
+}
+
+void CausalDiscovery::setDecisionOnly(bool decisionOnly)
+{
+    m_decisionOnly = decisionOnly;
+}
+
+void CausalDiscovery::setResidualCacheBytes(size_t maxBytes)
+{
+    m_residualCache.setMaxBytes(maxBytes);
+}
+
+const CITestCache &CausalDiscovery::getCITestCache() const
+{
+    return m_ciTestCache;
+}
+
+const ResidualCache &CausalDiscovery::getResidualCache() const
+{
+    return m_residualCache;
+}
+
+const SepsetStore &CausalDiscovery::getSepsets() const
+{
+    return m_sepsets;
+}
+
+double CausalDiscovery::testIndependence(const std::shared_ptr<const Dataset> &data, int i, int j, std::span<const int> conditioningSet, IncrementalCholesky *factor)
+{
+    double p_value;
+    if (m_ciTestCache.lookup(i, j, conditioningSet, p_value))
+    {
+        return p_value;
+    }
+
+    // The correlation matrix and the dense tests would see the NaNs, so these tests bypass them
+    if (m_missingValues == MissingValues::TestWiseDeletion && Statistic::hasMissingValues(*data, i, j, conditioningSet))
+    {
+        p_value = Statistic::testConditionalIndependenceTestWise(*data, i, j, conditioningSet, m_ciTestStatistic, m_criticalCorrelation.get());
+    }
+    else if (m_ciTestMode == CITestMode::Covariance)
+    {
+        p_value = Statistic::testConditionalIndependence(*m_correlations, i, j, conditioningSet, m_residualCache, m_ciTestStatistic, factor, m_criticalCorrelation.get());
+    }
+    else if (m_ciTestMode == CITestMode::InPlace)
+    {
+        p_value = Statistic::testConditionalIndependenceInPlace(*data, i, j, conditioningSet, m_residualCache, m_ciTestStatistic, factor, m_criticalCorrelation.get());
+    }
+    else
+    {
+        p_value = Statistic::testConditionalIndependence(data, i, j, conditioningSet, m_residualCache, m_ciTestStatistic, factor, m_criticalCorrelation.get());
+    }
+
+    m_ciTestCache.store(i, j, conditioningSet, p_value);
+    return p_value;
+}
 
 void CausalDiscovery::createFullyConnectedGraph(std::shared_ptr<Graph> graph)
 {
@@ -55,61 +147,140 @@ void CausalDiscovery::enforceRequiredEdges(std::shared_ptr<Graph> graph) {
     }
 }
 
-void CausalDiscovery::addToConditioningSet(std::set<int> &conditioningSet, int numVertices, int i, int j)
+bool CausalDiscovery::isFixedByConstraints(const std::shared_ptr<Graph> &graph, int i, int j) const
 {
-    for (int k = 0; k < numVertices; ++k)
-    {
-        if (k == i || k == j || conditioningSet.find(k) != conditioningSet.end())
-        {
-            continue;
-        }
-
-        conditioningSet.insert(k);
-        return;
-    }
-
-    throw std::runtime_error("No valid vertex to add to the conditioning set");
+    return graph->isForbiddenEdge(i, j) || graph->isForbiddenEdge(j, i) || graph->isRequiredEdge(i, j) || graph->isRequiredEdge(j, i);
 }
 
 void CausalDiscovery::applyPCAlgorithm(std::shared_ptr<Graph> graph, double alpha)
 {
-    /* ...  iteratively increasing the size of the conditioning set and removing edges when independence is detected...*/
+    /* PC-stable: iteratively increasing the size of the conditioning set and removing edges when independence is detected.
+       Conditioning sets of size depth are drawn from adj(i) \ {j} and adj(j) \ {i}. Adjacency is frozen within a level,
+       every remaining edge is searched in parallel and removals are applied afterwards, so the result does not depend
+       on the number of threads. */
 
     int numVertices = graph->getNumVertices();
     std::shared_ptr<const Dataset> data = graph->getDataset();
 
-    for (int i = 0; i < numVertices; ++i)
+    int maxDepth = numVertices - 2;
+    if (m_maxConditioningDepth >= 0)
+    {
+        maxDepth = std::min(maxDepth, m_maxConditioningDepth);
+    }
+
+    struct EdgeSearch
+    {
+        int i;
+        int j;
+        bool independent;
+        std::vector<int> sepset;
+    };
+
+    ThreadPool pool(m_numThreads);
+
+    // One factorization per worker for the whole search. Consecutive subsets share a prefix,
+    // so it moves from one set to the next a variable at a time, whichever edge the set
+    // belongs to; InPlace factors read the run's shared cross-products. Views are factored by
+    // the masked kernels instead. Regression stays on QR: where the conditioning set fits a
+    // tested variable exactly, its decision depends on the rounding left in the residual,
+    // which a factor does not reproduce.
+    std::vector<std::optional<IncrementalCholesky>> factors(pool.getNumThreads());
+    for (auto &factor : factors)
+    {
+        if (m_ciTestMode == CITestMode::Covariance)
+        {
+            factor.emplace(*m_correlations);
+        }
+        else if (m_ciTestMode == CITestMode::InPlace && m_crossProducts)
+        {
+            factor.emplace(*m_crossProducts);
+        }
+    }
+
+    BitMatrix adjacency;
+    std::vector<int> degree(numVertices);
+    std::vector<EdgeSearch> edges;
+
+    for (int depth = 0; depth <= maxDepth; ++depth)
     {
-        for (int j = i + 1; j < numVertices; ++j)
+        adjacency = graph->getAdjacencyMatrix().symmetrized();
+        for (int v = 0; v < numVertices; ++v)
         {
-            std::set<int> conditioningSet;
+            degree[v] = static_cast<int>(adjacency.count(v));
+        }
 
-            while (conditioningSet.size() < numVertices - 2)
+        // Only edges with enough neighbours on one side to draw a set of this size
+        edges.clear();
+        for (int i = 0; i < numVertices; ++i)
+        {
+            for (int j : adjacency.setBits(i))
             {
-                double p_value = Statistic::testConditionalIndependence(data, i, j, conditioningSet);
-                bool independent = p_value > alpha;
+                if (j > i && (degree[i] > depth || degree[j] > depth) && !isFixedByConstraints(graph, i, j))
+                {
+                    edges.push_back({ i, j, false, {} });
+                }
+            }
+        }
+
+        if (edges.empty())
+        {
+            break;
+        }
 
-                // TODO: add domain-specific rules whether remove edge or not
+        pool.parallelFor(edges.size(), [&](size_t k, size_t worker) {
+            thread_local CombinationGenerator subsets;
+            thread_local std::vector<int> candidates;
 
-                if (independent)
+            EdgeSearch &edge = edges[k];
+            std::optional<IncrementalCholesky> &factor = factors[worker];
+
+            for (int side = 0; side < 2 && !edge.independent; ++side)
+            {
+                int own = side == 0 ? edge.i : edge.j;
+                int other = side == 0 ? edge.j : edge.i;
+
+                candidates.clear();
+                for (int v : adjacency.setBits(own))
                 {
-                    graph->removeSingleEdge(i, j);
-                    graph->removeSingleEdge(j, i);
-                    break;
+                    if (v != other)
+                    {
+                        candidates.push_back(v);
+                    }
                 }
-                else
+
+                subsets.reset(candidates, depth);
+                while (subsets.next())
                 {
-                    try
+                    std::span<const int> subset = subsets.current();
+
+                    // Subsets of adj(i) were already tested from the first side
+                    if (side == 1 && std::all_of(subset.begin(), subset.end(), [&](int v) {
+                            return adjacency.test(edge.i, v);
+                        }))
                     {
-                        addToConditioningSet(conditioningSet, numVertices, i, j);
+                        continue;
                     }
-                    catch (const std::runtime_error &e)
+
+                    if (testIndependence(data, edge.i, edge.j, subset, factor ? &*factor : nullptr) > alpha)
                     {
-                        std::cerr << e.what() << std::endl;
+                        edge.independent = true;
+                        edge.sepset.assign(subset.begin(), subset.end());
                         break;
                     }
                 }
             }
+        });
+
+        for (const EdgeSearch &edge : edges)
+        {
+            // TODO: add domain-specific rules whether remove edge or not
+
+            if (edge.independent)
+            {
+                graph->removeSingleEdge(edge.i, edge.j);
+                graph->removeSingleEdge(edge.j, edge.i);
+                m_sepsets.record(edge.i, edge.j, std::set<int>(edge.sepset.begin(), edge.sepset.end()));
+            }
         }
     }
 }
@@ -129,9 +300,9 @@ void CausalDiscovery::pruneGraph(std::shared_ptr<Graph> graph, double alpha)
                 int secondNeighbor = neighbors[j];
 
                 // Check if an edge exists between firstNeighbor and secondNeighbor before running the independence test
-                if (graph->hasDoubleDirectedEdge(firstNeighbor, secondNeighbor))
+                if (graph->hasDoubleDirectedEdge(firstNeighbor, secondNeighbor) && !isFixedByConstraints(graph, firstNeighbor, secondNeighbor))
                 {
-                    double p_value = Statistic::testConditionalIndependence(data, firstNeighbor, secondNeighbor, { conditioningNode });
+                    double p_value = testIndependence(data, firstNeighbor, secondNeighbor, std::span<const int>(&conditioningNode, 1));
                     bool independent = p_value > alpha;
 
                     // TODO: add domain-specific rules whether remove edge or not
@@ -139,6 +310,7 @@ void CausalDiscovery::pruneGraph(std::shared_ptr<Graph> graph, double alpha)
                     if (independent) 
                     {
                         graph->removeSingleEdge(firstNeighbor, secondNeighbor);
+                        m_sepsets.record(firstNeighbor, secondNeighbor, { conditioningNode });
                     }
                 }
             }
@@ -161,19 +333,27 @@ void CausalDiscovery::orientVStructures(std::shared_ptr<Graph> graph, double alp
                 int Y = neighbors[j];
                 if (!graph->hasDoubleDirectedEdge(X, Y))
                 {
-                    double p_value = Statistic::testConditionalIndependence(data, X, Y, {Z});
-                    bool independent = p_value > alpha;
+                    // Collider iff Z is not in the set that separated X and Y. Pairs that were never
+                    // separated by a test (e.g. forbidden edges) still need the test itself.
+                    bool independent;
+                    if (m_sepsets.hasSepset(X, Y))
+                    {
+                        independent = m_sepsets.contains(X, Y, Z);
+                    }
+                    else
+                    {
+                        double p_value = testIndependence(data, X, Y, std::span<const int>(&Z, 1));
+                        independent = p_value > alpha;
+                    }
 
                     // TODO: maybe we could use domain-specific rules to orient the edges
                     // but now, I wouldn't change on this
 
                     if (!independent)
                     {
-                        //graph->orientEdge(X, Z);
-                        //graph->orientEdge(Y, Z);
-
-                        graph->removeSingleEdge(Z, X);
-                        graph->removeSingleEdge(Z, Y);
+                        // Collider X *-> Z <-* Y: arrowheads at Z, the marks at X and Y stay as they are
+                        graph->setEndpointMark(X, Z, EndpointMark::Arrow);
+                        graph->setEndpointMark(Y, Z, EndpointMark::Arrow);
                     }
                 }
             }
@@ -181,141 +361,86 @@ void CausalDiscovery::orientVStructures(std::shared_ptr<Graph> graph, double alp
     }
 }
 
-std::vector<std::vector<int>> CausalDiscovery::powerSet(const std::vector<int> &originalSet)
+bool CausalDiscovery::removePossibleDSepEdges(std::shared_ptr<Graph> graph, double alpha)
 {
-    std::vector<std::vector<int>> resultSet;
-    resultSet.push_back({});
-
-    for (int elem : originalSet)
-    {
-        std::vector<std::vector<int>> newSets;
-        for (auto &subset : resultSet)
-        {
-            std::vector<int> newSubset = subset;
-            newSubset.push_back(elem);
-            newSets.push_back(newSubset);
-        }
-        resultSet.insert(resultSet.end(), newSets.begin(), newSets.end());
-    }
+    /* FCI's second skeleton pass: an edge X *-* Y that survived the skeleton may still be separated by a set
+       containing vertices that are not adjacent to X, but lie on a Possible-D-Sep path from it. Every edge is
+       tested given subsets of Possible-D-Sep(X) \ {Y} and of Possible-D-Sep(Y) \ {X}, taken from the PAG
+       as it was after the v-structures, so the result does not depend on the order of the edges. */
 
-    return resultSet;
-}
-
-bool CausalDiscovery::areDSeparated(std::shared_ptr<Graph> graph, int node1, int node2, const std::vector<int> &conditioningSet)
-{
-    std::vector<bool> visited(graph->getNumVertices(), false);
+    std::shared_ptr<const Dataset> data = graph->getDataset();
+    int numVertices = static_cast<int>(graph->getNumVertices());
+    BitMatrix adjacency = graph->getAdjacencyMatrix().symmetrized();
 
-    for (int node : conditioningSet)
+    int maxDepth = numVertices - 2;
+    if (m_maxConditioningDepth >= 0)
     {
-        visited[node] = true;
+        maxDepth = std::min(maxDepth, m_maxConditioningDepth);
     }
 
-    std::stack<int> stack;
-    stack.push(node1);
+    PossibleDSep possibleDSep(*graph);
+    CombinationGenerator subsets;
+    std::vector<int> reachable;
+    std::vector<int> candidates;
+    bool removed = false;
 
-    while (!stack.empty())
+    for (int x = 0; x < numVertices; ++x)
     {
-        int node = stack.top();
-        stack.pop();
-
-        if (node == node2)
+        for (int y : adjacency.setBits(x))
         {
-            return false;
-        }
-
-        if (!visited[node])
-        {
-            visited[node] = true;
-            for (int neighbor : graph->getNeighbors(node))
+            if (y < x || isFixedByConstraints(graph, x, y))
             {
-                if (!visited[neighbor])
-                {
-                    stack.push(neighbor);
-                }
+                continue;
             }
-        }
-    }
-
-    return true;
-}
-
-std::set<std::pair<int, int>> CausalDiscovery::identifyPossibleDSep(std::shared_ptr<Graph> graph)
-{
-    std::set<std::pair<int, int>> dsepSet;
-    int numVertices = graph->getNumVertices();
-    std::vector<int> nodes(numVertices);
-    for (int i = 0; i < numVertices; ++i)
-    {
-        nodes[i] = i;
-    }
 
-    for (int i = 0; i < nodes.size(); ++i)
-    {
-        for (int j = i + 1; j < nodes.size(); ++j)
-        {
-            std::vector<int> otherNodes;
-            for (int k = 0; k < nodes.size(); ++k)
+            bool independent = false;
+            for (int side = 0; side < 2 && !independent; ++side)
             {
-                if (k != i && k != j)
+                int own = side == 0 ? x : y;
+                int other = side == 0 ? y : x;
+
+                possibleDSep.compute(own, reachable);
+                candidates.clear();
+                for (int v : reachable)
                 {
-                    otherNodes.push_back(nodes[k]);
+                    if (v != other)
+                    {
+                        candidates.push_back(v);
+                    }
                 }
-            }
 
-            for (auto &subset : powerSet(otherNodes))
-            {
-                if (areDSeparated(graph, nodes[i], nodes[j], subset))
+                int depthLimit = std::min(maxDepth, static_cast<int>(candidates.size()));
+                for (int depth = 1; depth <= depthLimit && !independent; ++depth)
                 {
-                    dsepSet.insert({nodes[i], nodes[j]});
+                    subsets.reset(candidates, depth);
+                    while (subsets.next())
+                    {
+                        std::span<const int> subset = subsets.current();
+
+                        // The skeleton search already tested every subset of the current adjacencies
+                        if (std::all_of(subset.begin(), subset.end(), [&](int v) {
+                                return adjacency.test(own, v);
+                            }))
+                        {
+                            continue;
+                        }
+
+                        if (testIndependence(data, x, y, subset) > alpha)
+                        {
+                            graph->removeSingleEdge(x, y);
+                            graph->removeSingleEdge(y, x);
+                            m_sepsets.record(x, y, std::set<int>(subset.begin(), subset.end()));
+                            independent = true;
+                            removed = true;
+                            break;
+                        }
+                    }
                 }
             }
         }
     }
 
-    return dsepSet;
-}
-
-bool CausalDiscovery::shouldOrientEdge(std::shared_ptr<Graph> graph, int node1, int node2, double alpha) {
-    // Placeholder for actual FCI rule logic
-    // For example, you might check for certain conditions in the graph
-    // and decide whether to orient the edge from node1 to node2
-    // This is a simplified example and should be replaced with actual FCI rules
-
-    // Example condition: If node1 has a directed edge to node2, orient the edge
-    if (graph->hasDirectedEdge(node1, node2)) {
-        return true;
-    }
-
-    // Example condition: If node2 has a directed edge to node1, orient the edge in the opposite direction
-    if (graph->hasDoubleDirectedEdge(node2, node1)) {
-        //graph->orientEdge(node2, node1);
-        graph->removeSingleEdge(node1, node2);
-        return false;
-    }
-
-    // Add more FCI rules as needed
-    return false;
-}
-
-void CausalDiscovery::applyFCIRules(std::shared_ptr<Graph> graph, double alpha, const std::set<std::pair<int, int>> &possibleDSep)
-{
-    for (const auto& edge : graph->getEdges()) {
-        int node1 = std::get<0>(edge);
-        int node2 = std::get<1>(edge);
-        bool isOriented = std::get<2>(edge);
-
-        if (possibleDSep.find({ node1, node2 }) != possibleDSep.end()) {
-            // Apply FCI rules to orient the edge
-            if (!isOriented) {
-                // Example FCI rule: Orient the edge based on some condition
-                // This is a placeholder. Replace with actual FCI rule application.
-                if (shouldOrientEdge(graph, node1, node2, alpha)) {
-                    //graph->orientEdge(node1, node2);
-                    graph->removeSingleEdge(node2, node1);
-                }
-            }
-        }
-    }
+    return removed;
 }
 
 void CausalDiscovery::applyDirectionConstraints(std::shared_ptr<Graph> graph) {
@@ -349,7 +474,7 @@ void CausalDiscovery::finalOrientation(std::shared_ptr<Graph> graph)
         int dest = std::get<1>(edge);
         bool isOriented = std::get<2>(edge);
 
-        // Orient the edge if it is not already oriented
+        // Only o-o edges are oriented here: an arrowhead or a tail, as on X <-> Z, is left as found
         if (!isOriented)
         {
             // Check if there's a direction constraint
@@ -381,6 +506,32 @@ void CausalDiscovery::runFCI(std::shared_ptr<Graph> graph, double alpha)
     applyForbiddenEdges(graph);
     enforceRequiredEdges(graph);
 
+    m_ciTestCache.clear();
+    m_residualCache.clear();
+    m_criticalCorrelation = nullptr;
+    if (m_decisionOnly)
+    {
+        // No conditioning set holds more than the other vertices of the tested pair
+        int maxDepth = std::max(static_cast<int>(graph->getNumVertices()) - 2, 0);
+        if (m_maxConditioningDepth >= 0)
+        {
+            maxDepth = std::min(maxDepth, m_maxConditioningDepth);
+        }
+        m_criticalCorrelation = std::make_unique<const CriticalCorrelation>(alpha, m_ciTestStatistic, graph->getDataset()->getSampleSize(), static_cast<size_t>(maxDepth));
+    }
+    m_sepsets.reset(graph->getNumVertices());
+
+    m_correlations = nullptr;
+    m_crossProducts = nullptr;
+    if (m_ciTestMode == CITestMode::Covariance)
+    {
+        m_correlations = std::make_shared<CorrelationMatrix>(*graph->getDataset());
+    }
+    else if (m_ciTestMode == CITestMode::InPlace && !graph->getDataset()->getRowSelection())
+    {
+        m_crossProducts = std::make_shared<CrossProductMatrix>(*graph->getDataset());
+    }
+
     // Step 2
     applyPCAlgorithm(graph, alpha);
 
@@ -391,11 +542,26 @@ void CausalDiscovery::runFCI(std::shared_ptr<Graph> graph, double alpha)
     enforceRequiredEdges(graph);
 
     // Step 4
+    Graph skeleton = *graph;
     orientVStructures(graph, alpha);
 
-    // Step 5
-    std::set<std::pair<int, int>> possibleDSep = identifyPossibleDSep(graph);
-    applyFCIRules(graph, alpha, possibleDSep);
+    // Step 5: edges removed given Possible-D-Sep sets invalidate the v-structures, which are found again
+    // on the skeleton without them
+    if (removePossibleDSepEdges(graph, alpha))
+    {
+        for (const auto &edge : skeleton.getEdges())
+        {
+            int a = std::get<0>(edge);
+            int b = std::get<1>(edge);
+            if (!graph->hasDirectedEdge(a, b) && !graph->hasDirectedEdge(b, a))
+            {
+                skeleton.removeSingleEdge(a, b);
+                skeleton.removeSingleEdge(b, a);
+            }
+        }
+        *graph = skeleton;
+        orientVStructures(graph, alpha);
+    }
 
     // Step 6
     finalOrientation(graph);
@@ -3,18 +3,58 @@
 
 #include "Graph.h"
 #include "Dataset.h"
+#include "statistic.h"
+#include "ciTestCache.h"
+#include "incrementalCholesky.h"
+#include "residualCache.h"
+#include "sepsetStore.h"
 #include <memory>
 #include <set>
 
 class CausalDiscovery
 {
+    CITestMode m_ciTestMode = CITestMode::Regression;
+    CITestStatistic m_ciTestStatistic = CITestStatistic::TStatistic;
+    MissingValues m_missingValues = MissingValues::Propagate;
+
+    // Worker threads for the skeleton search; 0 uses every hardware thread
+    size_t m_numThreads = 0;
+
+    // Largest conditioning set tried by the skeleton search; -1 means no cap
+    int m_maxConditioningDepth = -1;
+
+    // Set per run when only the decisions p > alpha are needed, not the p-values
+    bool m_decisionOnly = false;
+    std::unique_ptr<const CriticalCorrelation> m_criticalCorrelation;
+
+    // Built once per run in CITestMode::Covariance
+    std::shared_ptr<const CorrelationMatrix> m_correlations;
+
+    // Built once per run in CITestMode::InPlace and read by every worker's factor
+    std::shared_ptr<const CrossProductMatrix> m_crossProducts;
+
+    // p-values shared by every phase of a run; (i, j, S) triples repeat across phases
+    CITestCache m_ciTestCache;
+
+    // Regressions of one variable on a conditioning set, reused for every partner tested given that set
+    ResidualCache m_residualCache;
+
+    // Sets that separated each removed pair, recorded by the skeleton and pruning phases
+    SepsetStore m_sepsets;
+
+    // conditioningSet is sorted ascending; it is read in place, as the subset generators hand it out.
+    // factor, if given, is a factorization of the conditioning sets a worker tests in turn,
+    // built for the CI test mode; test-wise deletion ignores it
+    double testIndependence(const std::shared_ptr<const Dataset> &data, int i, int j, std::span<const int> conditioningSet, IncrementalCholesky *factor = nullptr);
+
     // Step 1: create fully connected graph and remove forbidden edges
     void createFullyConnectedGraph(std::shared_ptr<Graph> graph);
     void applyForbiddenEdges(std::shared_ptr<Graph> graph);
     void enforceRequiredEdges(std::shared_ptr<Graph> graph);
 
     // Step 2
-    void addToConditioningSet(std::set<int> &conditioningSet, int numVertices, int i, int j);
+    // Forbidden and required pairs keep their adjacency whatever a CI test says, so they are never tested
+    bool isFixedByConstraints(const std::shared_ptr<Graph> &graph, int i, int j) const;
 
     void applyPCAlgorithm(std::shared_ptr<Graph> graph, double alpha);
 
@@ -24,22 +64,33 @@ class CausalDiscovery
     // Step 4
     void orientVStructures(std::shared_ptr<Graph> graph, double alpha);
 
-    // Step 5
-    std::vector<std::vector<int>> powerSet(const std::vector<int> &originalSet);
-
-    bool areDSeparated(std::shared_ptr<Graph> graph, int node1, int node2, const std::vector<int> &conditioningSet);
-
-    std::set<std::pair<int, int>> identifyPossibleDSep(std::shared_ptr<Graph> graph);
-
-    bool shouldOrientEdge(std::shared_ptr<Graph> graph, int node1, int node2, double alpha);
-
-    void applyFCIRules(std::shared_ptr<Graph> graph, double alpha, const std::set<std::pair<int, int>> &possibleDSep);
+    // Step 5: removes the edges separated by a subset of Possible-D-Sep and records their sets;
+    // true if any edge was removed
+    bool removePossibleDSepEdges(std::shared_ptr<Graph> graph, double alpha);
 
     // Step 6
     void finalOrientation(std::shared_ptr<Graph> graph);
     void applyDirectionConstraints(std::shared_ptr<Graph> graph);
 
 public:
+    void setCITestMode(CITestMode mode);
+    void setCITestStatistic(CITestStatistic statistic);
+    void setMissingValues(MissingValues missingValues);
+    void setNumThreads(size_t numThreads);
+    void setMaxConditioningDepth(int maxDepth);
+
+    // Compare each (partial) correlation with the critical one for alpha instead of computing
+    // its p-value. The graph is the same; the CI test cache then holds 1.0 for independent
+    // and 0.0 for dependent pairs instead of p-values.
+    void setDecisionOnly(bool decisionOnly);
+
+    // Memory budget of the residual cache in bytes; 0 disables it
+    void setResidualCacheBytes(size_t maxBytes);
+
+    const CITestCache &getCITestCache() const;
+    const ResidualCache &getResidualCache() const;
+    const SepsetStore &getSepsets() const;
+
     void runFCI(std::shared_ptr<Graph> data, double alpha);
 };
 
@@ -1,15 +1,21 @@
 #include "CausalDiscoveryAPI.h"
 #include "CausalDiscovery.h"
 #include "CSVReader.h"
+#include "XLSXReader.h"
+#include "multiFileReader.h"
+#include "rowDeduplicator.h"
+#include "datasetCache.h"
 #include "Dataset.h"
 #include "Graph.h"
 
 #include <stdexcept>
+#include <iomanip>
 #include <iostream>
 
 CausalDiscoveryAPI::CausalDiscoveryAPI()
     : causalDiscovery_(std::make_shared<CausalDiscovery>()),
     alpha_(0.05),
+    testWiseDeletion_(false),
     graph_(nullptr)
 {
 }
@@ -24,10 +30,87 @@ void CausalDiscoveryAPI::setAlpha(double alpha) {
     alpha_ = alpha;
 }
 
+void CausalDiscoveryAPI::setNumThreads(size_t numThreads) {
+    causalDiscovery_->setNumThreads(numThreads);
+}
+
+void CausalDiscoveryAPI::setMaxConditioningDepth(int maxDepth) {
+    causalDiscovery_->setMaxConditioningDepth(maxDepth);
+}
+
+void CausalDiscoveryAPI::setTestWiseDeletion(bool enabled) {
+    testWiseDeletion_ = enabled;
+    causalDiscovery_->setMissingValues(enabled ? MissingValues::TestWiseDeletion : MissingValues::Propagate);
+}
+
 void CausalDiscoveryAPI::loadDatasetFromFile(const std::string& filename, int numColumns) {
-    auto columns = CSVReader::readCSVFile(filename, numColumns);
+    auto columns = CSVReader::readCSVFileMapped(filename, numColumns);
     auto data = std::make_shared<Dataset>(std::move(columns));
     graph_ = std::make_shared<Graph>(data);
+    columnNames_.clear();
+    loadStats_.clear();
+}
+
+void CausalDiscoveryAPI::loadDatasetFromFile(const std::string& filename, const std::vector<std::string>& columnNames) {
+    bool isWorkbook = filename.size() >= 5 && filename.compare(filename.size() - 5, 5, ".xlsx") == 0;
+    MissingFields missing = testWiseDeletion_ ? MissingFields::KeepAsNaN : MissingFields::DropRow;
+    auto columns = isWorkbook ? XLSXReader::readXLSXColumns(filename, columnNames, "", missing) : CSVReader::readCSVColumns(filename, columnNames, 0, missing);
+    auto data = std::make_shared<Dataset>(std::move(columns));
+    graph_ = std::make_shared<Graph>(data);
+    columnNames_ = columnNames;
+    loadStats_.clear();
+}
+
+void CausalDiscoveryAPI::loadDatasetFromFiles(const std::vector<std::string>& filenames, const std::vector<std::string>& columnNames) {
+    std::vector<FileLoadStats> stats;
+    MissingFields missing = testWiseDeletion_ ? MissingFields::KeepAsNaN : MissingFields::DropRow;
+    auto columns = MultiFileReader::readColumns(filenames, columnNames, &stats, 0, missing);
+    auto data = std::make_shared<Dataset>(std::move(columns));
+    graph_ = std::make_shared<Graph>(data);
+    columnNames_ = columnNames;
+    loadStats_ = std::move(stats);
+}
+
+const std::vector<FileLoadStats>& CausalDiscoveryAPI::getLoadStats() const {
+    return loadStats_;
+}
+
+void CausalDiscoveryAPI::printLoadStats() const {
+    std::ios::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+
+    size_t totalRows = 0;
+    for (const auto& file : loadStats_) {
+        std::cout << file.filename << ": " << file.numRows << " rows, "
+            << std::fixed << std::setprecision(2) << file.milliseconds << " ms" << std::endl;
+        totalRows += file.numRows;
+    }
+    std::cout << "Total: " << totalRows << " rows from " << loadStats_.size() << " files" << std::endl;
+
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
+
+void CausalDiscoveryAPI::deduplicateRows() {
+    if (!graph_) {
+        throw std::runtime_error("No dataset loaded. Please load a dataset before deduplicating it.");
+    }
+
+    graph_ = std::make_shared<Graph>(RowDeduplicator::deduplicate(*graph_->getDataset()));
+}
+
+void CausalDiscoveryAPI::saveDatasetCache(const std::string& filename) const {
+    if (!graph_) {
+        throw std::runtime_error("No dataset loaded. Please load a dataset before saving it.");
+    }
+
+    DatasetCache::save(filename, *graph_->getDataset(), columnNames_);
+}
+
+void CausalDiscoveryAPI::loadDatasetCache(const std::string& filename) {
+    auto data = DatasetCache::load(filename, columnNames_);
+    graph_ = std::make_shared<Graph>(data);
+    loadStats_.clear();
 }
 
 void CausalDiscoveryAPI::run() {
@@ -0,0 +1,99 @@
+#include "ciTestCache.h"
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+CITestCache::KeyView::KeyView(int i, int j, std::span<const int> conditioningSet)
+    : first(std::min(i, j)), second(std::max(i, j)), conditioningSet(conditioningSet) {
+}
+
+CITestCache::KeyView::KeyView(const Key& key) : first(key.first), second(key.second), conditioningSet(key.conditioningSet) {
+}
+
+size_t CITestCache::KeyHash::operator()(const KeyView& key) const {
+    size_t seed = std::hash<int>{}(key.first);
+    auto combine = [&seed](int value) {
+        seed ^= std::hash<int>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    };
+
+    combine(key.second);
+    for (int k : key.conditioningSet) {
+        combine(k);
+    }
+    return seed;
+}
+
+bool CITestCache::KeyEqual::operator()(const KeyView& a, const KeyView& b) const {
+    return a.first == b.first && a.second == b.second && std::ranges::equal(a.conditioningSet, b.conditioningSet);
+}
+
+CITestCache::Shard& CITestCache::shardOf(const KeyView& key) {
+    // The maps use the low bits of the same hash for their buckets, so pick the shard from the high ones
+    size_t mixed = static_cast<size_t>((KeyHash{}(key) * 0x9e3779b97f4a7c15ull) >> 32);
+    return m_shards[mixed % NumShards];
+}
+
+bool CITestCache::lookup(int i, int j, std::span<const int> conditioningSet, double& p_value) {
+    KeyView key(i, j, conditioningSet);
+    Shard& shard = shardOf(key);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.pValues.find(key);
+    if (it == shard.pValues.end()) {
+        ++shard.misses;
+        return false;
+    }
+
+    ++shard.hits;
+    p_value = it->second;
+    return true;
+}
+
+void CITestCache::store(int i, int j, std::span<const int> conditioningSet, double p_value) {
+    KeyView view(i, j, conditioningSet);
+    Shard& shard = shardOf(view);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.pValues.find(view);
+    if (it != shard.pValues.end()) {
+        it->second = p_value;
+        return;
+    }
+    shard.pValues.emplace(Key{ view.first, view.second, std::vector<int>(conditioningSet.begin(), conditioningSet.end()) }, p_value);
+}
+
+void CITestCache::clear() {
+    for (Shard& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.pValues.clear();
+        shard.hits = 0;
+        shard.misses = 0;
+    }
+}
+
+size_t CITestCache::size() const {
+    size_t total = 0;
+    for (const Shard& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.pValues.size();
+    }
+    return total;
+}
+
+size_t CITestCache::getHits() const {
+    size_t total = 0;
+    for (const Shard& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.hits;
+    }
+    return total;
+}
+
+size_t CITestCache::getMisses() const {
+    size_t total = 0;
+    for (const Shard& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.misses;
+    }
+    return total;
+}
@@ -0,0 +1,71 @@
+#ifndef CITESTCACHE_H
+#define CITESTCACHE_H
+
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// Memoizes p-values of conditional-independence tests for one discovery run.
+// The pair is unordered, so (i, j, S) and (j, i, S) share an entry; S must be sorted
+// ascending, as the discovery loops generate it. A lookup hashes and compares S where it
+// lies, so only storing a new entry allocates. Safe to use from several threads:
+// entries are spread over independently locked shards by the hash of their key,
+// so threads testing different triples rarely wait for each other.
+class CITestCache {
+public:
+    static constexpr size_t NumShards = 64;
+
+    bool lookup(int i, int j, std::span<const int> conditioningSet, double& p_value);
+    void store(int i, int j, std::span<const int> conditioningSet, double p_value);
+
+    void clear();
+
+    size_t size() const;
+    size_t getHits() const;
+    size_t getMisses() const;
+
+private:
+    struct Key {
+        int first;
+        int second;
+        std::vector<int> conditioningSet;
+
+    };
+
+    // A key over a borrowed conditioning set
+    struct KeyView {
+        int first;
+        int second;
+        std::span<const int> conditioningSet;
+
+        KeyView(int i, int j, std::span<const int> conditioningSet);
+        KeyView(const Key& key);
+    };
+
+    struct KeyHash {
+        using is_transparent = void;
+        size_t operator()(const KeyView& key) const;
+    };
+
+    struct KeyEqual {
+        using is_transparent = void;
+        bool operator()(const KeyView& a, const KeyView& b) const;
+    };
+
+    // One cache line each, so neighbouring shards' locks do not share a line
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<Key, double, KeyHash, KeyEqual> pValues;
+        size_t hits = 0;
+        size_t misses = 0;
+    };
+
+    Shard& shardOf(const KeyView& key);
+
+    std::array<Shard, NumShards> m_shards;
+};
+
+#endif // CITESTCACHE_H
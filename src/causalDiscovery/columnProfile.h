@@ -0,0 +1,130 @@
+#ifndef COLUMNPROFILE_H
+#define COLUMNPROFILE_H
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <Eigen/Core>
+#include "rowCounts.h"
+#include "validityBitmap.h"
+
+// Summary of one column, computed once when the column is added to a Dataset.
+// CI tests read these instead of rescanning the column, and use them to answer
+// degenerate tests (constant, NaN or duplicated columns) without any arithmetic.
+struct ColumnProfile {
+    size_t numRows = 0;
+    size_t nanCount = 0;
+
+    // Sample statistics over all rows, each row counted as often as its weight says;
+    // NaN when the column holds a NaN
+    double mean = std::numeric_limits<double>::quiet_NaN();
+    double variance = std::numeric_limits<double>::quiet_NaN();
+
+    // Extremes of the non-NaN values; NaN when there are none
+    double min = std::numeric_limits<double>::quiet_NaN();
+    double max = std::numeric_limits<double>::quiet_NaN();
+
+    // Every value compares equal to the first one (an empty column counts as constant)
+    bool constant = true;
+
+    // Equal columns have equal hashes; -0.0 and 0.0 hash alike since they compare equal
+    uint64_t hash = 0;
+
+    // weights, if not empty, are per-row frequency weights
+    static ColumnProfile compute(std::span<const double> values, std::span<const double> weights = {}) {
+        ColumnProfile profile;
+        profile.numRows = values.size();
+
+        uint64_t hash = 14695981039346656037ull; // FNV-1a over the value bits
+        for (double value : values) {
+            if (std::isnan(value)) {
+                ++profile.nanCount;
+            }
+            else if (std::isnan(profile.min)) {
+                profile.min = value;
+                profile.max = value;
+            }
+            else {
+                profile.min = value < profile.min ? value : profile.min;
+                profile.max = value > profile.max ? value : profile.max;
+            }
+            hash = (hash ^ std::bit_cast<uint64_t>(value == 0.0 ? 0.0 : value)) * 1099511628211ull;
+        }
+        profile.hash = hash;
+        profile.constant = values.empty() || (profile.nanCount == 0 && profile.min == profile.max);
+
+        if (!values.empty()) {
+            // Same reductions as the regression test used, so its p-values do not change
+            Eigen::Map<const Eigen::VectorXd> column(values.data(), static_cast<Eigen::Index>(values.size()));
+            if (weights.empty()) {
+                profile.mean = column.mean();
+                profile.variance = (column.array() - profile.mean).square().sum() / (column.size() - 1);
+            }
+            else {
+                Eigen::Map<const Eigen::VectorXd> weight(weights.data(), static_cast<Eigen::Index>(weights.size()));
+                double total = weight.sum();
+                profile.mean = weight.dot(column) / total;
+                profile.variance = weight.dot((column.array() - profile.mean).square().matrix()) / (total - 1);
+            }
+        }
+
+        return profile;
+    }
+
+    // Profile of the rows set in selection only, as a copy of those rows would have, each
+    // repeated as often as counts (if given) says. Rows outside the selection may hold
+    // anything, NaN included; numRows stays values.size().
+    static ColumnProfile compute(std::span<const double> values, std::span<const double> weights, const ValidityBitmap& selection, const RowCounts* counts = nullptr) {
+        ColumnProfile profile;
+        profile.numRows = values.size();
+
+        uint64_t hash = 14695981039346656037ull;
+        double total = 0.0;
+        double sum = 0.0;
+        auto forEachSelected = [&](auto&& visit) {
+            std::span<const ValidityBitmap::Word> words = selection.getWords();
+            for (size_t w = 0; w < words.size(); ++w) {
+                for (ValidityBitmap::Word mask = words[w]; mask; mask &= mask - 1) {
+                    size_t row = w * ValidityBitmap::WordBits + std::countr_zero(mask);
+                    double weight = weights.empty() ? 1.0 : weights[row];
+                    visit(values[row], counts ? weight * counts->get(row) : weight);
+                }
+            }
+        };
+
+        forEachSelected([&](double value, double weight) {
+            if (std::isnan(value)) {
+                ++profile.nanCount;
+            }
+            else if (std::isnan(profile.min)) {
+                profile.min = value;
+                profile.max = value;
+            }
+            else {
+                profile.min = value < profile.min ? value : profile.min;
+                profile.max = value > profile.max ? value : profile.max;
+            }
+            hash = (hash ^ std::bit_cast<uint64_t>(value == 0.0 ? 0.0 : value)) * 1099511628211ull;
+            total += weight;
+            sum += weight * value;
+        });
+        profile.hash = hash;
+        profile.constant = total == 0.0 || (profile.nanCount == 0 && profile.min == profile.max);
+
+        if (total > 0.0) {
+            profile.mean = sum / total;
+            double squares = 0.0;
+            forEachSelected([&](double value, double weight) {
+                squares += weight * (value - profile.mean) * (value - profile.mean);
+            });
+            profile.variance = squares / (total - 1);
+        }
+
+        return profile;
+    }
+};
+
+#endif // COLUMNPROFILE_H
@@ -0,0 +1,53 @@
+#include "combinationGenerator.h"
+#include <cstddef>
+#include <span>
+
+void CombinationGenerator::reset(std::span<const int> candidates, size_t k) {
+    m_candidates = candidates;
+    m_k = k;
+    m_positions.resize(k);
+    m_values.resize(k);
+    m_started = false;
+    m_exhausted = k > candidates.size();
+}
+
+bool CombinationGenerator::next() {
+    if (m_exhausted) {
+        return false;
+    }
+
+    size_t n = m_candidates.size();
+
+    if (!m_started) {
+        m_started = true;
+        for (size_t a = 0; a < m_k; ++a) {
+            m_positions[a] = a;
+            m_values[a] = m_candidates[a];
+        }
+        return true;
+    }
+
+    // Rightmost position that can still move; everything after it restarts right behind it
+    size_t a = m_k;
+    while (a > 0 && m_positions[a - 1] == n - m_k + (a - 1)) {
+        --a;
+    }
+
+    if (a == 0) {
+        m_exhausted = true;
+        return false;
+    }
+
+    ++m_positions[a - 1];
+    m_values[a - 1] = m_candidates[m_positions[a - 1]];
+    for (size_t b = a; b < m_k; ++b) {
+        m_positions[b] = m_positions[b - 1] + 1;
+        m_values[b] = m_candidates[m_positions[b]];
+    }
+
+    return true;
+}
+
+std::span<const int> CombinationGenerator::current() const {
+    return std::span<const int>(m_values.data(), m_k);
+}
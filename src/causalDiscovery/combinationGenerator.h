@@ -0,0 +1,31 @@
+#ifndef COMBINATIONGENERATOR_H
+#define COMBINATIONGENERATOR_H
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Lazily enumerates the k-element subsets of a candidate list in lexicographic order.
+// Only the current subset is held; its buffers keep their capacity across reset()
+// calls, so a reused generator does not allocate once it has seen the largest k.
+class CombinationGenerator {
+public:
+    // The candidates must outlive the enumeration
+    void reset(std::span<const int> candidates, size_t k);
+
+    // Advances to the next subset; false once every subset has been produced
+    bool next();
+
+    // Subset produced by the last successful next(), in candidate order
+    std::span<const int> current() const;
+
+private:
+    std::span<const int> m_candidates;
+    std::vector<size_t> m_positions;
+    std::vector<int> m_values;
+    size_t m_k = 0;
+    bool m_started = false;
+    bool m_exhausted = true;
+};
+
+#endif // COMBINATIONGENERATOR_H
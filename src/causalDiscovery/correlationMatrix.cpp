@@ -0,0 +1,170 @@
+#include "correlationMatrix.h"
+#include "dataset.h"
+#include <Eigen/Dense>
+#include <Eigen/QR>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+using namespace Eigen;
+using namespace std;
+
+CorrelationMatrix::CorrelationMatrix(const Dataset& data) : m_numRows(0) {
+    size_t num_vars = data.getNumOfColumns();
+
+    // Views read the columns in place in either storage mode
+    vector<span<const double>> columns(num_vars);
+    for (size_t k = 0; k < num_vars; ++k) {
+        columns[k] = data.getStoredColumnView(static_cast<int>(k));
+        if (k > 0 && columns[k].size() != m_numRows) {
+            throw runtime_error("All columns must have the same number of rows.");
+        }
+        m_numRows = columns[k].size();
+    }
+
+    // Weighted rows stand for as many observations as their weight
+    span<const double> weights = data.getRowWeights();
+    const ValidityBitmap* selection = data.getRowSelection();
+    const RowCounts* counts = data.getRowCounts();
+    size_t num_stored_rows = m_numRows;
+    if (!weights.empty() || selection) {
+        m_numRows = data.getSampleSize();
+    }
+
+    // sqrt of each row's weight (times its count in a view), zero for the rows a view leaves out
+    VectorXd scale;
+    if (selection) {
+        scale = VectorXd::Zero(num_stored_rows);
+        for (size_t row = 0; row < num_stored_rows; ++row) {
+            if (selection->isValid(row)) {
+                double weight = weights.empty() ? 1.0 : weights[row];
+                scale[row] = sqrt(counts ? weight * counts->get(row) : weight);
+            }
+        }
+    }
+    else if (!weights.empty()) {
+        scale = Map<const VectorXd>(weights.data(), num_stored_rows).cwiseSqrt();
+    }
+
+    if (num_vars > 0 && m_numRows < 2) {
+        throw runtime_error("At least two rows are required to compute correlations.");
+    }
+
+    // Centre every column once, then fill the upper triangle with one dot product per pair.
+    // With weights each centred row is scaled by sqrt(w), so the dot products come out weighted.
+    vector<VectorXd> centered(num_vars);
+    VectorXd stdev(num_vars);
+    m_constant.assign(num_vars, false);
+
+    for (size_t k = 0; k < num_vars; ++k) {
+        const ColumnProfile& profile = data.getColumnProfile(static_cast<int>(k));
+        Map<const VectorXd> col(columns[k].data(), num_stored_rows);
+        centered[k] = col.array() - profile.mean;
+        if (selection) {
+            // select, not a product: a left-out row may hold NaN
+            centered[k] = (scale.array() > 0).select(centered[k].array() * scale.array(), 0.0);
+        }
+        else if (!weights.empty()) {
+            centered[k].array() *= scale.array();
+        }
+        stdev[k] = sqrt(centered[k].squaredNorm());
+        m_constant[k] = profile.constant || stdev[k] == 0;
+    }
+
+    m_correlation = MatrixXd::Identity(num_vars, num_vars);
+    for (size_t a = 0; a < num_vars; ++a) {
+        for (size_t b = a + 1; b < num_vars; ++b) {
+            double corr = 0.0;
+            if (!m_constant[a] && !m_constant[b]) {
+                corr = centered[a].dot(centered[b]) / (stdev[a] * stdev[b]);
+            }
+            m_correlation(a, b) = corr;
+            m_correlation(b, a) = corr;
+        }
+    }
+}
+
+size_t CorrelationMatrix::getNumRows() const {
+    return m_numRows;
+}
+
+size_t CorrelationMatrix::getNumVariables() const {
+    return static_cast<size_t>(m_correlation.rows());
+}
+
+bool CorrelationMatrix::isConstant(int i) const {
+    return m_constant.at(i);
+}
+
+double CorrelationMatrix::getCorrelation(int i, int j) const {
+    return m_correlation(i, j);
+}
+
+namespace {
+
+// Correlation of the residuals from their 2x2 covariance; 1.0 when either vanishes
+double residualCorrelation(double var_i, double var_j, double cov_ij) {
+    if (var_i < numeric_limits<double>::epsilon() || var_j < numeric_limits<double>::epsilon()) {
+        return 1.0;
+    }
+    return cov_ij / sqrt(var_i * var_j);
+}
+
+// Partial correlation given N conditioning variables: R_yy - R_yS * R_SS^+ * R_Sy. With a
+// fixed N the matrices and their QR live on the stack; N == Dynamic is the generic fallback.
+template <int N>
+double partialCorrelationKernel(const MatrixXd& correlation, int i, int j, const int* cond, Index num_cond) {
+    Matrix<double, N, N> R_SS;
+    Matrix<double, N, 2> R_Sy;
+    R_SS.resize(num_cond, num_cond);
+    R_Sy.resize(num_cond, 2);
+    for (Index a = 0; a < num_cond; ++a) {
+        for (Index b = 0; b < num_cond; ++b) {
+            R_SS(a, b) = correlation(cond[a], cond[b]);
+        }
+        R_Sy(a, 0) = correlation(cond[a], i);
+        R_Sy(a, 1) = correlation(cond[a], j);
+    }
+
+    Matrix<double, N, 2> beta = R_SS.colPivHouseholderQr().solve(R_Sy);
+    Matrix2d residual;
+    residual << 1.0, correlation(i, j),
+                correlation(i, j), 1.0;
+    residual -= R_Sy.transpose() * beta;
+
+    return residualCorrelation(residual(0, 0), residual(1, 1), residual(0, 1));
+}
+
+// One conditioning variable: the recursive formula (r_ij - r_ik r_jk) / sqrt((1 - r_ik^2)(1 - r_jk^2))
+template <>
+double partialCorrelationKernel<1>(const MatrixXd& correlation, int i, int j, const int* cond, Index) {
+    double r_ik = correlation(i, cond[0]);
+    double r_jk = correlation(j, cond[0]);
+    return residualCorrelation(1.0 - r_ik * r_ik, 1.0 - r_jk * r_jk, correlation(i, j) - r_ik * r_jk);
+}
+
+} // namespace
+
+double CorrelationMatrix::partialCorrelation(int i, int j, span<const int> conditioningSet) const {
+    Index num_cond = static_cast<Index>(conditioningSet.size());
+    const int* cond = conditioningSet.data();
+    if (num_cond > MaxFixedConditioning) {
+        return partialCorrelationKernel<Dynamic>(m_correlation, i, j, cond, num_cond);
+    }
+
+    switch (num_cond) {
+    case 0:
+        return m_correlation(i, j);
+    case 1:
+        return partialCorrelationKernel<1>(m_correlation, i, j, cond, num_cond);
+    case 2:
+        return partialCorrelationKernel<2>(m_correlation, i, j, cond, num_cond);
+    case 3:
+        return partialCorrelationKernel<3>(m_correlation, i, j, cond, num_cond);
+    default:
+        return partialCorrelationKernel<4>(m_correlation, i, j, cond, num_cond);
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef CORRELATIONMATRIX_H
+#define CORRELATIONMATRIX_H
+
+#include "dataset.h"
+#include <span>
+#include <vector>
+#include <Eigen/Dense>
+
+// Pearson correlation matrix of every column pair, computed once per Dataset.
+// Partial correlations are answered from the (|S|+2)x(|S|+2) submatrix, so the
+// cost of a conditional-independence test no longer depends on the row count.
+// Being correlations, the partial correlations are those of the centered columns, i.e. of
+// regressions with an intercept.
+class CorrelationMatrix {
+public:
+    explicit CorrelationMatrix(const Dataset& data);
+
+    size_t getNumRows() const;
+    size_t getNumVariables() const;
+
+    bool isConstant(int i) const;
+
+    double getCorrelation(int i, int j) const;
+
+    // Conditioning sets up to this size are solved by kernels specialized for their size,
+    // which allocate nothing; larger ones take a generic dynamic-size solve
+    static constexpr int MaxFixedConditioning = 4;
+
+    // Correlation of i and j after partialling out the conditioning set, sorted ascending.
+    // Returns 1.0 when either residual variance vanishes (perfect dependence).
+    double partialCorrelation(int i, int j, std::span<const int> conditioningSet) const;
+
+private:
+    Eigen::MatrixXd m_correlation;
+    std::vector<bool> m_constant;
+    size_t m_numRows;
+};
+
+#endif // CORRELATIONMATRIX_H
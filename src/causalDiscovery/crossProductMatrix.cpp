@@ -0,0 +1,45 @@
+#include "crossProductMatrix.h"
+#include <cmath>
+#include <span>
+#include <stdexcept>
+
+using namespace Eigen;
+using namespace std;
+
+CrossProductMatrix::CrossProductMatrix(const Dataset& data) {
+    if (data.getRowSelection()) {
+        throw invalid_argument("CrossProductMatrix reads whole columns and cannot cover a view.");
+    }
+
+    Index num_vars = static_cast<Index>(data.getNumOfColumns());
+    Index num_rows = num_vars == 0 ? 0 : static_cast<Index>(data.getColumnView(0).size());
+    for (Index k = 1; k < num_vars; ++k) {
+        if (static_cast<Index>(data.getColumnView(static_cast<int>(k)).size()) != num_rows) {
+            throw runtime_error("All columns must have the same number of rows.");
+        }
+    }
+
+    // One symmetric rank-N update fills the lower triangle; unweighted contiguous storage is
+    // read where it lies, other data is copied once with each row scaled by sqrt(w)
+    m_crossProducts = MatrixXd::Zero(num_vars, num_vars);
+    span<const double> weights = data.getRowWeights();
+    if (data.getStorage() != DatasetStorage::Columns && weights.empty()) {
+        m_crossProducts.selfadjointView<Lower>().rankUpdate(data.getMatrix().transpose());
+    }
+    else {
+        MatrixXd columns(num_rows, num_vars);
+        for (Index k = 0; k < num_vars; ++k) {
+            span<const double> values = data.getColumnView(static_cast<int>(k));
+            columns.col(k) = Map<const VectorXd>(values.data(), num_rows);
+        }
+        if (!weights.empty()) {
+            columns.array().colwise() *= Map<const VectorXd>(weights.data(), num_rows).array().sqrt();
+        }
+        m_crossProducts.selfadjointView<Lower>().rankUpdate(columns.transpose());
+    }
+    m_crossProducts.triangularView<StrictlyUpper>() = m_crossProducts.transpose();
+}
+
+size_t CrossProductMatrix::getNumVariables() const {
+    return static_cast<size_t>(m_crossProducts.rows());
+}
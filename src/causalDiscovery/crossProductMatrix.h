@@ -0,0 +1,25 @@
+#ifndef CROSSPRODUCTMATRIX_H
+#define CROSSPRODUCTMATRIX_H
+
+#include "dataset.h"
+#include <Eigen/Dense>
+
+// Raw (uncentred) cross-products X^T W X of every column pair, computed once per Dataset:
+// the Gram matrix the InPlace test regresses on. Read-only once built, so the factors of all
+// workers of a run can share one.
+class CrossProductMatrix {
+public:
+    // Weighted if data is; views are rejected
+    explicit CrossProductMatrix(const Dataset& data);
+
+    size_t getNumVariables() const;
+
+    double getCrossProduct(int a, int b) const {
+        return m_crossProducts(a, b);
+    }
+
+private:
+    Eigen::MatrixXd m_crossProducts;
+};
+
+#endif // CROSSPRODUCTMATRIX_H
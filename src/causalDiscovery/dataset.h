@@ -1,17 +1,70 @@
 #ifndef DATASET_H
 #define DATASET_H
 
+#include "alignedAllocator.h"
+#include "columnProfile.h"
+#include "rowCounts.h"
+#include "validityBitmap.h"
 #include <vector>
+#include <algorithm>
+#include <bit>
+#include <cmath>
 #include <cstddef>
 #include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
 #include <utility> // For std::move
+#include <Eigen/Core>
 
 typedef std::vector<double> Column;
 
+enum class DatasetStorage
+{
+    Columns,   // one heap-allocated vector per column
+    Contiguous, // one 64-byte aligned column-major buffer for the whole dataset
+    Mapped      // the Contiguous layout in memory the Dataset does not own, e.g. a mapped cache file; read-only
+};
+
 class Dataset
 {
+public:
+    // Column-major view of contiguous storage; column c starts at c * getColumnStride()
+    using MatrixView = Eigen::Map<const Eigen::MatrixXd, Eigen::Aligned64, Eigen::OuterStride<>>;
+
+    static constexpr size_t Alignment = 64;
+
+private:
     std::vector<std::shared_ptr<Column>> m_columns;
 
+    DatasetStorage m_storage = DatasetStorage::Columns;
+
+    // Contiguous storage: every column is padded to m_stride values so each one starts on a cache line
+    std::vector<double, AlignedAllocator<double, Alignment>> m_values;
+    size_t m_numColumns = 0;
+    size_t m_numRows = 0;
+    size_t m_stride = 0;
+
+    // Mapped storage: values laid out as in contiguous storage, kept alive by m_owner
+    std::shared_ptr<const void> m_owner;
+    const double* m_mappedValues = nullptr;
+
+    // One profile per column, computed as the column is added
+    std::vector<ColumnProfile> m_profiles;
+
+    // Rows holding a value, per column; null for columns without NaN
+    std::vector<std::shared_ptr<const ValidityBitmap>> m_validity;
+
+    // Frequency weight of each row, e.g. how many input rows a deduplicated row stands for;
+    // null when every row counts once. Shared with the views taken of this dataset.
+    std::shared_ptr<const Column> m_rowWeights;
+    size_t m_sampleSize = 0;
+
+    // Views only: the rows of the shared storage that belong to the dataset, and how often
+    // each of them was picked (null unless some row was picked more than once)
+    std::shared_ptr<const ValidityBitmap> m_selection;
+    std::shared_ptr<const RowCounts> m_rowCounts;
+
 public:
 
     Dataset() = default;
@@ -26,27 +79,170 @@ public:
         }
     }
 
+    Dataset(std::vector<Column> init_vector, DatasetStorage storage) : m_storage(storage)
+    {
+        if (m_storage == DatasetStorage::Contiguous)
+        {
+            reserveContiguous(init_vector.size(), init_vector.empty() ? 0 : init_vector[0].size());
+        }
+
+        for (auto& column : init_vector)
+        {
+            addColumn(std::move(column));
+        }
+    }
+
+    // Rows weighted by rowWeights: row r counts as rowWeights[r] observations in every
+    // statistic, so a weighted unique row gives the same results as its repeats
+    Dataset(std::vector<Column> init_vector, Column rowWeights, DatasetStorage storage = DatasetStorage::Columns) : m_storage(storage)
+    {
+        for (double weight : rowWeights)
+        {
+            if (!(weight > 0) || weight != std::floor(weight))
+            {
+                throw std::invalid_argument("Row weights must be positive integers.");
+            }
+            m_sampleSize += static_cast<size_t>(weight);
+        }
+        m_rowWeights = std::make_shared<const Column>(std::move(rowWeights));
+
+        if (m_storage == DatasetStorage::Contiguous)
+        {
+            reserveContiguous(init_vector.size(), m_rowWeights->size());
+        }
+
+        for (auto& column : init_vector)
+        {
+            addColumn(std::move(column));
+        }
+    }
+
+    // Wraps numColumns x stride column-major values owned by owner, which must stay unchanged
+    // for the lifetime of the Dataset. The profiles are taken as given rather than recomputed.
+    Dataset(std::shared_ptr<const void> owner, const double* values, size_t numColumns, size_t numRows, size_t stride, std::vector<ColumnProfile> profiles)
+        : m_storage(DatasetStorage::Mapped), m_numColumns(numColumns), m_numRows(numRows), m_stride(stride),
+        m_owner(std::move(owner)), m_mappedValues(values), m_profiles(std::move(profiles))
+    {
+        if (m_profiles.size() != numColumns || stride < numRows)
+        {
+            throw std::invalid_argument("Mapped dataset layout does not match its column count.");
+        }
+
+        for (size_t c = 0; c < numColumns; ++c)
+        {
+            m_validity.push_back(m_profiles[c].nanCount > 0 ? std::make_shared<const ValidityBitmap>(ValidityBitmap::fromColumn(getColumnView(static_cast<int>(c)))) : nullptr);
+        }
+    }
+
     virtual ~Dataset() = default;
 
+protected:
+    // Dataset over the rows of parent set in selection, sharing parent's column storage: the
+    // columns themselves in Columns storage, the whole buffer (as Mapped storage) otherwise.
+    // A selected row weighs its weight in parent times its count in rowCounts, if given.
+    // Used by DatasetView.
+    Dataset(const std::shared_ptr<const Dataset>& parent, std::shared_ptr<const ValidityBitmap> selection, std::shared_ptr<const RowCounts> rowCounts)
+        : m_columns(parent->m_columns),
+        m_storage(parent->m_storage == DatasetStorage::Columns ? DatasetStorage::Columns : DatasetStorage::Mapped),
+        m_numColumns(parent->m_numColumns), m_numRows(parent->m_numRows), m_stride(parent->m_stride),
+        m_validity(parent->m_validity),
+        m_rowWeights(parent->m_rowWeights),
+        m_selection(std::move(selection)), m_rowCounts(std::move(rowCounts))
+    {
+        if (parent->m_selection)
+        {
+            throw std::invalid_argument("A view cannot be taken of another view; take it of the parent dataset.");
+        }
+        if (m_storage == DatasetStorage::Mapped)
+        {
+            m_owner = parent;
+            m_mappedValues = parent->contiguousValues();
+        }
+
+        std::span<const double> weights = getRowWeights();
+        for (size_t c = 0; c < getNumOfColumns(); ++c)
+        {
+            m_profiles.push_back(ColumnProfile::compute(getStoredColumnView(static_cast<int>(c)), weights, *m_selection, m_rowCounts.get()));
+        }
+
+        std::span<const ValidityBitmap::Word> words = m_selection->getWords();
+        for (size_t w = 0; w < words.size(); ++w)
+        {
+            for (ValidityBitmap::Word mask = words[w]; mask; mask &= mask - 1)
+            {
+                size_t row = w * ValidityBitmap::WordBits + std::countr_zero(mask);
+                size_t count = m_rowCounts ? m_rowCounts->get(row) : 1;
+                m_sampleSize += weights.empty() ? count : count * static_cast<size_t>(weights[row]);
+            }
+        }
+    }
+
+public:
+
     void addColumn(const Column& column)
     {
-        m_columns.push_back(std::make_shared<Column>(column));
+        if (m_storage == DatasetStorage::Mapped || m_selection)
+        {
+            throw std::runtime_error("Columns cannot be added to a mapped dataset or a view.");
+        }
+        if (m_rowWeights && column.size() != m_rowWeights->size())
+        {
+            throw std::invalid_argument("Every column of a weighted dataset needs one value per weight.");
+        }
+        if (m_storage == DatasetStorage::Contiguous)
+        {
+            appendContiguous(column);
+        }
+        else
+        {
+            m_columns.push_back(std::make_shared<Column>(column));
+        }
+        describeLastColumn();
     }
 
     void addColumn(Column&& column)
     {
-        m_columns.push_back(std::make_shared<Column>(std::move(column)));
+        if (m_storage == DatasetStorage::Mapped || m_selection)
+        {
+            throw std::runtime_error("Columns cannot be added to a mapped dataset or a view.");
+        }
+        if (m_rowWeights && column.size() != m_rowWeights->size())
+        {
+            throw std::invalid_argument("Every column of a weighted dataset needs one value per weight.");
+        }
+        if (m_storage == DatasetStorage::Contiguous)
+        {
+            appendContiguous(column);
+        }
+        else
+        {
+            m_columns.push_back(std::make_shared<Column>(std::move(column)));
+        }
+        describeLastColumn();
     }
 
     size_t getNumOfColumns() const
     {
-        return m_columns.size();
+        return m_storage == DatasetStorage::Columns ? m_columns.size() : m_numColumns;
     }
 
+    DatasetStorage getStorage() const
+    {
+        return m_storage;
+    }
+
+    // In contiguous storage this returns a copy; prefer getColumnView there. Throws on a view,
+    // like getColumnView.
     virtual std::shared_ptr<Column> getColumn(int i) const
     {
-        if (i >= 0 && i < m_columns.size())
+        if (i >= 0 && i < static_cast<int>(getNumOfColumns()))
         {
+            throwIfView("getColumn");
+            if (m_storage != DatasetStorage::Columns)
+            {
+                std::span<const double> view = getStoredColumnView(i);
+                return std::make_shared<Column>(view.begin(), view.end());
+            }
             return m_columns[i];
         }
         else
@@ -55,6 +251,168 @@ public:
             // TODO: throw std::out_of_range("Index out of range in Dataset::getColumn");
         }
     }
+
+    // Values of column i without copying, for either storage mode. A view has no column of
+    // its own rows, so it throws there; see getStoredColumnView.
+    std::span<const double> getColumnView(int i) const
+    {
+        throwIfView("getColumnView");
+        return getStoredColumnView(i);
+    }
+
+    // Every stored row of column i. On a view these are all of the parent's rows, selected or
+    // not: the rows that belong to the view are those set in getRowSelection.
+    std::span<const double> getStoredColumnView(int i) const
+    {
+        if (i < 0 || i >= static_cast<int>(getNumOfColumns()))
+        {
+            throw std::out_of_range("Index out of range in Dataset::getColumnView");
+        }
+
+        if (m_storage != DatasetStorage::Columns)
+        {
+            return std::span<const double>(contiguousValues() + i * m_stride, m_numRows);
+        }
+        return std::span<const double>(m_columns[i]->data(), m_columns[i]->size());
+    }
+
+    const ColumnProfile& getColumnProfile(int i) const
+    {
+        if (i < 0 || i >= static_cast<int>(getNumOfColumns()))
+        {
+            throw std::out_of_range("Index out of range in Dataset::getColumnProfile");
+        }
+        return m_profiles[i];
+    }
+
+    // Empty unless the rows carry frequency weights. On a view these are the parent's, one per
+    // stored row; a row picked more than once also has a count in getRowCounts.
+    std::span<const double> getRowWeights() const
+    {
+        return m_rowWeights ? std::span<const double>(*m_rowWeights) : std::span<const double>();
+    }
+
+    // Null unless this is a view; then only the rows set here belong to the dataset, and the
+    // stored columns and the weights also cover rows outside it
+    const ValidityBitmap* getRowSelection() const
+    {
+        return m_selection.get();
+    }
+
+    // Null unless this is a view that picks some row more than once; then a selected row
+    // stands for its weight times its count
+    const RowCounts* getRowCounts() const
+    {
+        return m_rowCounts.get();
+    }
+
+    // Number of observations the rows stand for: the sum of the (selected) weights, or the row count
+    size_t getSampleSize() const
+    {
+        if (m_rowWeights || m_selection)
+        {
+            return m_sampleSize;
+        }
+        return getNumOfColumns() == 0 ? 0 : getColumnView(0).size();
+    }
+
+    // Null when column i has no missing (NaN) values, which is the common case
+    const ValidityBitmap* getValidity(int i) const
+    {
+        if (i < 0 || i >= static_cast<int>(getNumOfColumns()))
+        {
+            throw std::out_of_range("Index out of range in Dataset::getValidity");
+        }
+        return m_validity[i].get();
+    }
+
+    // Columns i and j hold exactly the same values; the profile hashes rule out most pairs without a scan
+    bool areDuplicateColumns(int i, int j) const
+    {
+        const ColumnProfile& profile_i = getColumnProfile(i);
+        const ColumnProfile& profile_j = getColumnProfile(j);
+        if (profile_i.hash != profile_j.hash || profile_i.numRows != profile_j.numRows)
+        {
+            return false;
+        }
+
+        std::span<const double> col_i = getStoredColumnView(i);
+        std::span<const double> col_j = getStoredColumnView(j);
+        if (m_selection)
+        {
+            for (size_t row = 0; row < col_i.size(); ++row)
+            {
+                if (m_selection->isValid(row) && col_i[row] != col_j[row])
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        return std::equal(col_i.begin(), col_i.end(), col_j.begin());
+    }
+
+    // Whole dataset as a numRows x numColumns matrix; contiguous and mapped storage only, and
+    // not on a view, whose rows are not all of the stored ones
+    MatrixView getMatrix() const
+    {
+        throwIfView("getMatrix");
+        if (m_storage == DatasetStorage::Columns)
+        {
+            throw std::runtime_error("Dataset does not use contiguous storage.");
+        }
+
+        return MatrixView(contiguousValues(), m_numRows, m_numColumns, Eigen::OuterStride<>(m_stride));
+    }
+
+    size_t getColumnStride() const
+    {
+        return m_stride;
+    }
+
+private:
+    void throwIfView(const char* accessor) const
+    {
+        if (m_selection)
+        {
+            throw std::runtime_error(std::string("Dataset::") + accessor + " would return rows outside the view; use getStoredColumnView with getRowSelection.");
+        }
+    }
+
+    void describeLastColumn()
+    {
+        std::span<const double> values = getColumnView(static_cast<int>(getNumOfColumns()) - 1);
+        m_profiles.push_back(ColumnProfile::compute(values, getRowWeights()));
+        m_validity.push_back(m_profiles.back().nanCount > 0 ? std::make_shared<const ValidityBitmap>(ValidityBitmap::fromColumn(values)) : nullptr);
+    }
+
+    const double* contiguousValues() const
+    {
+        return m_storage == DatasetStorage::Mapped ? m_mappedValues : m_values.data();
+    }
+
+    void reserveContiguous(size_t numColumns, size_t numRows)
+    {
+        m_numRows = numRows;
+        m_stride = (numRows + Alignment / sizeof(double) - 1) / (Alignment / sizeof(double)) * (Alignment / sizeof(double));
+        m_values.reserve(numColumns * m_stride);
+    }
+
+    void appendContiguous(const Column& column)
+    {
+        if (m_numColumns == 0 && m_values.capacity() == 0)
+        {
+            reserveContiguous(1, column.size());
+        }
+        if (column.size() != m_numRows)
+        {
+            throw std::invalid_argument("All columns must have the same number of rows in contiguous storage.");
+        }
+
+        m_values.insert(m_values.end(), column.begin(), column.end());
+        m_values.resize((m_numColumns + 1) * m_stride, 0.0);
+        ++m_numColumns;
+    }
 };
 
 #endif // DATASET_H
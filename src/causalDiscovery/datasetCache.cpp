@@ -0,0 +1,199 @@
+#include "datasetCache.h"
+#include "mappedFile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr char Magic[8] = { 'C', 'D', 'D', 'S', 'C', 'A', 'C', 'H' };
+constexpr uint32_t DTypeFloat64 = 1;
+constexpr uint32_t ByteOrderMark = 0x01020304;
+constexpr uint64_t PayloadAlignment = Dataset::Alignment;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;
+    uint32_t byteOrderMark;
+    uint32_t reserved;
+    uint64_t numColumns;
+    uint64_t numRows;
+    uint64_t stride;
+    uint64_t profilesOffset;
+    uint64_t payloadOffset;
+};
+static_assert(sizeof(FileHeader) == 64, "The cache header is 64 bytes on disk");
+
+struct ProfileRecord {
+    uint64_t numRows;
+    uint64_t nanCount;
+    double mean;
+    double variance;
+    double min;
+    double max;
+    uint64_t hash;
+    uint64_t constant;
+};
+static_assert(sizeof(ProfileRecord) == 64, "A cached column profile is 64 bytes on disk");
+
+uint64_t roundUp(uint64_t value, uint64_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+void writePadding(std::ofstream& out, uint64_t from, uint64_t to) {
+    static const char zeros[PayloadAlignment] = {};
+    while (from < to) {
+        uint64_t chunk = std::min<uint64_t>(to - from, sizeof(zeros));
+        out.write(zeros, static_cast<std::streamsize>(chunk));
+        from += chunk;
+    }
+}
+
+std::runtime_error invalidFile(const std::string& filename, const std::string& reason) {
+    return std::runtime_error("Invalid dataset cache file " + filename + ": " + reason);
+}
+
+} // namespace
+
+void DatasetCache::save(const std::string& filename, const Dataset& data, const std::vector<std::string>& columnNames) {
+    uint64_t numColumns = data.getNumOfColumns();
+    if (!columnNames.empty() && columnNames.size() != numColumns) {
+        throw std::invalid_argument("Expected one column name per column.");
+    }
+    if (!data.getRowWeights().empty()) {
+        // The format has no place for row weights; cache the dataset before deduplicating it
+        throw std::invalid_argument("Datasets with row weights cannot be cached.");
+    }
+    if (data.getRowSelection()) {
+        throw std::invalid_argument("Dataset views cannot be cached; cache the parent dataset.");
+    }
+
+    uint64_t numRows = numColumns == 0 ? 0 : data.getColumnView(0).size();
+    for (int c = 1; c < static_cast<int>(numColumns); ++c) {
+        if (data.getColumnView(c).size() != numRows) {
+            throw std::invalid_argument("All columns must have the same number of rows.");
+        }
+    }
+
+    uint64_t namesSize = 0;
+    for (uint64_t c = 0; c < numColumns; ++c) {
+        namesSize += sizeof(uint32_t) + (columnNames.empty() ? 0 : columnNames[c].size());
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.dtype = DTypeFloat64;
+    header.byteOrderMark = ByteOrderMark;
+    header.numColumns = numColumns;
+    header.numRows = numRows;
+    header.stride = roundUp(numRows, PayloadAlignment / sizeof(double));
+    header.profilesOffset = roundUp(sizeof(FileHeader) + namesSize, alignof(ProfileRecord));
+    header.payloadOffset = roundUp(header.profilesOffset + numColumns * sizeof(ProfileRecord), PayloadAlignment);
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("Could not open the file: " + filename);
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (uint64_t c = 0; c < numColumns; ++c) {
+        const std::string name = columnNames.empty() ? std::string() : columnNames[c];
+        uint32_t length = static_cast<uint32_t>(name.size());
+        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.write(name.data(), static_cast<std::streamsize>(name.size()));
+    }
+    writePadding(out, sizeof(FileHeader) + namesSize, header.profilesOffset);
+
+    for (int c = 0; c < static_cast<int>(numColumns); ++c) {
+        const ColumnProfile& profile = data.getColumnProfile(c);
+        ProfileRecord record{ profile.numRows, profile.nanCount, profile.mean, profile.variance,
+                              profile.min, profile.max, profile.hash, profile.constant ? 1u : 0u };
+        out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+    writePadding(out, header.profilesOffset + numColumns * sizeof(ProfileRecord), header.payloadOffset);
+
+    for (int c = 0; c < static_cast<int>(numColumns); ++c) {
+        std::span<const double> values = data.getColumnView(c);
+        out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size_bytes()));
+        writePadding(out, 0, (header.stride - numRows) * sizeof(double));
+    }
+
+    if (!out) {
+        throw std::runtime_error("Could not write the file: " + filename);
+    }
+}
+
+std::shared_ptr<Dataset> DatasetCache::load(const std::string& filename) {
+    std::vector<std::string> columnNames;
+    return load(filename, columnNames);
+}
+
+std::shared_ptr<Dataset> DatasetCache::load(const std::string& filename, std::vector<std::string>& columnNames) {
+    auto file = std::make_shared<MappedFile>(filename);
+    const char* base = file->data();
+    uint64_t size = file->size();
+
+    FileHeader header;
+    if (size < sizeof(header)) {
+        throw invalidFile(filename, "file is too short");
+    }
+    std::memcpy(&header, base, sizeof(header));
+
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) {
+        throw invalidFile(filename, "bad magic");
+    }
+    if (header.version != Version) {
+        throw invalidFile(filename, "unsupported version " + std::to_string(header.version));
+    }
+    if (header.dtype != DTypeFloat64 || header.byteOrderMark != ByteOrderMark) {
+        throw invalidFile(filename, "unsupported value type or byte order");
+    }
+
+    // Every count is checked against the file size before it is used in a product
+    uint64_t numColumns = header.numColumns;
+    if (header.stride < header.numRows || header.payloadOffset % PayloadAlignment != 0 || header.payloadOffset > size
+        || header.profilesOffset > header.payloadOffset || numColumns > (header.payloadOffset - header.profilesOffset) / sizeof(ProfileRecord)
+        || (numColumns > 0 && header.stride > (size - header.payloadOffset) / sizeof(double) / numColumns)) {
+        throw invalidFile(filename, "truncated or inconsistent layout");
+    }
+
+    columnNames.clear();
+    columnNames.reserve(numColumns);
+    uint64_t offset = sizeof(FileHeader);
+    for (uint64_t c = 0; c < numColumns; ++c) {
+        uint32_t length;
+        if (offset + sizeof(length) > header.profilesOffset) {
+            throw invalidFile(filename, "truncated column names");
+        }
+        std::memcpy(&length, base + offset, sizeof(length));
+        offset += sizeof(length);
+        if (offset + length > header.profilesOffset) {
+            throw invalidFile(filename, "truncated column names");
+        }
+        columnNames.emplace_back(base + offset, length);
+        offset += length;
+    }
+
+    std::vector<ColumnProfile> profiles(numColumns);
+    for (uint64_t c = 0; c < numColumns; ++c) {
+        ProfileRecord record;
+        std::memcpy(&record, base + header.profilesOffset + c * sizeof(ProfileRecord), sizeof(record));
+        profiles[c] = ColumnProfile{ record.numRows, record.nanCount, record.mean, record.variance,
+                                     record.min, record.max, record.constant != 0, record.hash };
+    }
+
+    const double* values = reinterpret_cast<const double*>(base + header.payloadOffset);
+    return std::make_shared<Dataset>(file, values, numColumns, header.numRows, header.stride, std::move(profiles));
+}
+
+bool DatasetCache::isCacheFile(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    char magic[sizeof(Magic)] = {};
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, Magic, sizeof(Magic)) == 0;
+}
@@ -0,0 +1,36 @@
+#ifndef DATASETCACHE_H
+#define DATASETCACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "dataset.h"
+
+// Binary columnar snapshot of a Dataset that reloads without parsing.
+//
+// Layout (native byte order, all offsets from the start of the file):
+//   header       64 bytes: magic "CDDSCACH", version, dtype, byte-order mark, counts and offsets
+//   names        per column: uint32 length followed by the UTF-8 bytes
+//   profiles     per column: one 64-byte ColumnProfile record
+//   payload      64-byte aligned, column-major float64, every column padded to the same stride
+//
+// load() maps the file and returns a Dataset in DatasetStorage::Mapped that reads the payload
+// in place, so reopening costs one mmap call regardless of the row count.
+class DatasetCache {
+public:
+    static constexpr uint32_t Version = 1;
+
+    // Column names are optional; when given there must be one per column. Datasets with row
+    // weights and dataset views are rejected with std::invalid_argument.
+    static void save(const std::string& filename, const Dataset& data, const std::vector<std::string>& columnNames = {});
+
+    // Throws std::runtime_error if the file is not a cache file of this version
+    static std::shared_ptr<Dataset> load(const std::string& filename);
+    static std::shared_ptr<Dataset> load(const std::string& filename, std::vector<std::string>& columnNames);
+
+    // True if the file starts with the cache magic, whatever its version
+    static bool isCacheFile(const std::string& filename);
+};
+
+#endif // DATASETCACHE_H
@@ -0,0 +1,116 @@
+#ifndef DATASETVIEW_H
+#define DATASETVIEW_H
+
+#include "dataset.h"
+#include "rowCounts.h"
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// A subset of the rows of a parent dataset that shares the parent's column storage, for
+// resampling (bootstrap, subsampling, cross-validation) without copying the data. The
+// selected rows are kept as a bitmap over the parent rows, so a view costs one bit per parent
+// row plus the column profiles; a bootstrap view that picks rows more than once adds a count
+// per selected row. Statistic, CorrelationMatrix and the graph searches honour the selection.
+// getColumn, getColumnView and getMatrix throw, as the view's rows are not a column of the
+// storage; getStoredColumnView returns all of the parent's rows.
+class DatasetView : public Dataset
+{
+public:
+    // Rows may repeat, as in a bootstrap sample: a row picked k times weighs k times its
+    // weight in the parent. No row may be picked more than RowCounts::MaxCount times.
+    DatasetView(std::shared_ptr<const Dataset> parent, const std::vector<size_t>& rows)
+        : DatasetView(parent, selectRows(*parent, rows))
+    {
+    }
+
+    // Rows set in selection, which must cover as many rows as the parent
+    DatasetView(std::shared_ptr<const Dataset> parent, ValidityBitmap selection)
+        : DatasetView(parent, Selection{ std::make_shared<const ValidityBitmap>(std::move(selection)), nullptr })
+    {
+    }
+
+    const std::shared_ptr<const Dataset>& getParent() const
+    {
+        return m_parent;
+    }
+
+    // Number of distinct parent rows in the view
+    size_t getNumSelectedRows() const
+    {
+        return getRowSelection()->countValid();
+    }
+
+private:
+    struct Selection
+    {
+        std::shared_ptr<const ValidityBitmap> rows;
+        std::shared_ptr<const RowCounts> counts; // null unless rows repeat
+    };
+
+    DatasetView(const std::shared_ptr<const Dataset>& parent, Selection selection)
+        : Dataset(checkedParent(parent, *selection.rows), selection.rows, std::move(selection.counts)), m_parent(parent)
+    {
+    }
+
+    static size_t parentRows(const Dataset& parent)
+    {
+        return parent.getNumOfColumns() == 0 ? 0 : parent.getStoredColumnView(0).size();
+    }
+
+    static const std::shared_ptr<const Dataset>& checkedParent(const std::shared_ptr<const Dataset>& parent, const ValidityBitmap& rows)
+    {
+        if (rows.getNumRows() != parentRows(*parent))
+        {
+            throw std::invalid_argument("Row selection does not match the parent dataset.");
+        }
+        return parent;
+    }
+
+    static Selection selectRows(const Dataset& parent, const std::vector<size_t>& rows)
+    {
+        size_t numRows = parentRows(parent);
+        auto bitmap = std::make_shared<ValidityBitmap>(ValidityBitmap::allClear(numRows));
+        bool repeated = false;
+        for (size_t row : rows)
+        {
+            if (row >= numRows)
+            {
+                throw std::invalid_argument("Row index out of range in DatasetView.");
+            }
+            repeated = repeated || bitmap->isValid(row);
+            bitmap->setValid(row);
+        }
+
+        Selection selection{ std::move(bitmap), nullptr };
+        if (repeated)
+        {
+            // Sorted, the picks of a row are adjacent and the rows come in bitmap order
+            std::vector<size_t> sorted = rows;
+            std::sort(sorted.begin(), sorted.end());
+            std::vector<RowCounts::Count> counts;
+            counts.reserve(selection.rows->countValid());
+            for (size_t first = 0, last = 0; first < sorted.size(); first = last)
+            {
+                while (last < sorted.size() && sorted[last] == sorted[first])
+                {
+                    ++last;
+                }
+                if (last - first > RowCounts::MaxCount)
+                {
+                    throw std::invalid_argument("A row is picked too many times in DatasetView.");
+                }
+                counts.push_back(static_cast<RowCounts::Count>(last - first));
+            }
+            selection.counts = std::make_shared<const RowCounts>(selection.rows, std::move(counts));
+        }
+        return selection;
+    }
+
+    std::shared_ptr<const Dataset> m_parent;
+};
+
+#endif // DATASETVIEW_H
@@ -0,0 +1,28 @@
+#include "endpointMarkMatrix.h"
+#include <cstddef>
+#include <cstdint>
+
+EndpointMarkMatrix::EndpointMarkMatrix(size_t size) {
+    reset(size);
+}
+
+void EndpointMarkMatrix::reset(size_t size) {
+    m_size = size;
+    m_wordsPerRow = (size + MarksPerWord - 1) / MarksPerWord;
+    m_words.assign(m_size * m_wordsPerRow, 0);
+}
+
+size_t EndpointMarkMatrix::size() const {
+    return m_size;
+}
+
+EndpointMark EndpointMarkMatrix::get(size_t from, size_t to) const {
+    uint64_t word = m_words[from * m_wordsPerRow + to / MarksPerWord];
+    return static_cast<EndpointMark>((word >> (2 * (to % MarksPerWord))) & 0x3);
+}
+
+void EndpointMarkMatrix::set(size_t from, size_t to, EndpointMark mark) {
+    uint64_t& word = m_words[from * m_wordsPerRow + to / MarksPerWord];
+    size_t shift = 2 * (to % MarksPerWord);
+    word = (word & ~(uint64_t(0x3) << shift)) | (uint64_t(static_cast<uint8_t>(mark)) << shift);
+}
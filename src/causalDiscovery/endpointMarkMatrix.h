@@ -0,0 +1,42 @@
+#ifndef ENDPOINTMARKMATRIX_H
+#define ENDPOINTMARKMATRIX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Mark at one end of a PAG edge. None means the vertices are not adjacent.
+enum class EndpointMark : uint8_t {
+    None = 0,
+    Tail = 1,
+    Arrow = 2,
+    Circle = 3
+};
+
+// Dense n x n matrix of 2-bit endpoint marks, 32 per 64-bit word.
+// Entry (a, b) is the mark at b on the edge between a and b, so a -> b is
+// stored as (a, b) = Arrow and (b, a) = Tail.
+class EndpointMarkMatrix {
+public:
+    EndpointMarkMatrix() = default;
+    explicit EndpointMarkMatrix(size_t size);
+
+    // Resizes to size x size with every mark set to None
+    void reset(size_t size);
+
+    size_t size() const;
+
+    EndpointMark get(size_t from, size_t to) const;
+    void set(size_t from, size_t to, EndpointMark mark);
+
+    friend bool operator==(const EndpointMarkMatrix& lhs, const EndpointMarkMatrix& rhs) = default;
+
+private:
+    static constexpr size_t MarksPerWord = 32;
+
+    size_t m_size = 0;
+    size_t m_wordsPerRow = 0;
+    std::vector<uint64_t> m_words;
+};
+
+#endif // ENDPOINTMARKMATRIX_H
@@ -11,8 +11,11 @@ Graph::Graph(std::shared_ptr<Dataset> dataset) : m_dataset(std::move(dataset))
     if (!m_dataset) {
         throw std::invalid_argument("Dataset cannot be null");
     }
-    int numVertices = m_dataset->getNumOfColumns();
-    m_adjList.resize(numVertices);
+    m_adjacency.reset(m_dataset->getNumOfColumns());
+    m_marks.reset(m_dataset->getNumOfColumns());
+    m_forbiddenIndex.reset(m_dataset->getNumOfColumns());
+    m_requiredIndex.reset(m_dataset->getNumOfColumns());
+    m_directionIndex.reset(m_dataset->getNumOfColumns());
 }
 
 std::shared_ptr<const Dataset> Graph::getDataset() const {
@@ -20,74 +23,167 @@ std::shared_ptr<const Dataset> Graph::getDataset() const {
 }
 
 void Graph::addDirectedEdge(int src, int dest) {
-    if (src >= 0 && src < m_adjList.size()) {
-        m_adjList[src].insert(dest);
+    if (isVertex(src) && isVertex(dest) && !m_adjacency.test(src, dest)) {
+        m_adjacency.set(src, dest);
+        updateMarksFromAdjacency(src, dest);
     }
 }
 
 void Graph::addDoubleDirectedEdge(int src, int dest) {
-    if (src >= 0 && src < m_adjList.size() && dest >= 0 && dest < m_adjList.size()) {
-        m_adjList[src].insert(dest);
-        m_adjList[dest].insert(src);
+    if (isVertex(src) && isVertex(dest) && !hasDoubleDirectedEdge(src, dest)) {
+        m_adjacency.set(src, dest);
+        m_adjacency.set(dest, src);
+        updateMarksFromAdjacency(src, dest);
     }
 }
 
-/*bool Graph::hasEdge(int src, int dest) const {
-    if (src >= 0 && src < m_adjList.size() && dest >= 0 && dest < m_adjList.size()) {
-        return m_adjList[src].find(dest) != m_adjList[src].end();
-    }
-    return false;
-}*/
-
 bool Graph::hasDirectedEdge(int src, int dest) const {
-    if (src >= 0 && src < m_adjList.size()) {
-        return m_adjList[src].find(dest) != m_adjList[src].end();
+    if (isVertex(src) && isVertex(dest)) {
+        return m_adjacency.test(src, dest);
     }
 
     return false;
 }
 
 bool Graph::hasDoubleDirectedEdge(int src, int dest) const {
-    if (src >= 0 && src < m_adjList.size() && dest >= 0 && dest < m_adjList.size()) {
-        bool srcToDest = m_adjList[src].find(dest) != m_adjList[src].end();
-        bool destToSrc = m_adjList[dest].find(src) != m_adjList[dest].end();
-
-        return srcToDest && destToSrc;
+    if (isVertex(src) && isVertex(dest)) {
+        return m_adjacency.test(src, dest) && m_adjacency.test(dest, src);
     }
     return false;
 }
 
 void Graph::removeSingleEdge(int src, int dest) {
-    if (src >= 0 && src < m_adjList.size() && dest >= 0 && dest < m_adjList.size()) {
-        m_adjList[src].erase(dest);
+    if (isVertex(src) && isVertex(dest) && m_adjacency.test(src, dest)) {
+        m_adjacency.clear(src, dest);
         // Note: we don't remove the edge from dest to src
+        updateMarksFromAdjacency(src, dest);
+    }
+}
+
+EndpointMark Graph::getEndpointMark(int from, int to) const {
+    if (isVertex(from) && isVertex(to)) {
+        return m_marks.get(from, to);
+    }
+
+    return EndpointMark::None;
+}
+
+void Graph::setEndpointMark(int from, int to, EndpointMark mark) {
+    if (!isVertex(from) || !isVertex(to) || m_marks.get(from, to) == EndpointMark::None) {
+        return;
+    }
+
+    if (mark == EndpointMark::None) {
+        m_marks.set(to, from, EndpointMark::None);
+    }
+    m_marks.set(from, to, mark);
+    updateAdjacencyFromMarks(from, to);
+}
+
+void Graph::setEdge(int a, int b, EndpointMark markAtA, EndpointMark markAtB) {
+    if (!isVertex(a) || !isVertex(b)) {
+        return;
+    }
+
+    if (markAtA == EndpointMark::None || markAtB == EndpointMark::None) {
+        markAtA = markAtB = EndpointMark::None;
+    }
+    m_marks.set(b, a, markAtA);
+    m_marks.set(a, b, markAtB);
+    updateAdjacencyFromMarks(a, b);
+}
+
+void Graph::updateMarksFromAdjacency(int a, int b) {
+    bool forward = m_adjacency.test(a, b);
+    bool backward = m_adjacency.test(b, a);
+
+    EndpointMark markAtA = EndpointMark::None;
+    EndpointMark markAtB = EndpointMark::None;
+    if (forward && backward) {
+        markAtA = markAtB = EndpointMark::Circle;
+    }
+    else if (forward) {
+        markAtA = EndpointMark::Tail;
+        markAtB = EndpointMark::Arrow;
+    }
+    else if (backward) {
+        markAtA = EndpointMark::Arrow;
+        markAtB = EndpointMark::Tail;
+    }
+
+    m_marks.set(b, a, markAtA);
+    m_marks.set(a, b, markAtB);
+}
+
+void Graph::updateAdjacencyFromMarks(int a, int b) {
+    EndpointMark markAtA = m_marks.get(b, a);
+    EndpointMark markAtB = m_marks.get(a, b);
+
+    if (markAtA == EndpointMark::None) {
+        m_adjacency.clear(a, b);
+        m_adjacency.clear(b, a);
+        return;
+    }
+
+    // The directed edge src -> dest is dropped only when src holds the edge's single arrowhead
+    bool intoA = markAtA == EndpointMark::Arrow && markAtB != EndpointMark::Arrow;
+    bool intoB = markAtB == EndpointMark::Arrow && markAtA != EndpointMark::Arrow;
+
+    if (intoA) {
+        m_adjacency.clear(a, b);
+    }
+    else {
+        m_adjacency.set(a, b);
+    }
+
+    if (intoB) {
+        m_adjacency.clear(b, a);
+    }
+    else {
+        m_adjacency.set(b, a);
     }
 }
 
 size_t Graph::getNumVertices() const {
-    return m_adjList.size();
+    return m_adjacency.size();
+}
+
+bool Graph::isVertex(int vertex) const {
+    return vertex >= 0 && static_cast<size_t>(vertex) < m_adjacency.size();
 }
 
 std::vector<int> Graph::getNeighbors(int vertex) const {
-    if (vertex >= 0 && vertex < m_adjList.size()) {
-        return std::vector<int>(m_adjList[vertex].begin(), m_adjList[vertex].end());
+    NeighborRange range = neighbors(vertex);
+    return std::vector<int>(range.begin(), range.end());
+}
+
+Graph::NeighborRange Graph::neighbors(int vertex) const {
+    if (isVertex(vertex)) {
+        return m_adjacency.setBits(vertex);
     }
 
-    return {};
+    return NeighborRange({});
 }
 
-/*void Graph::orientEdge(int src, int dest) {
-    if (src >= 0 && src < m_adjList.size() && dest >= 0 && dest < m_adjList.size()) {
-        m_adjList[dest].erase(src);
+size_t Graph::getOutDegree(int vertex) const {
+    if (isVertex(vertex)) {
+        return m_adjacency.count(vertex);
     }
-}*/
+
+    return 0;
+}
+
+const BitMatrix& Graph::getAdjacencyMatrix() const {
+    return m_adjacency;
+}
 
 void Graph::printGraph() const {
-    for (int i = 0; i < m_adjList.size(); ++i) {
+    int numVertices = static_cast<int>(getNumVertices());
+    for (int i = 0; i < numVertices; ++i) {
         std::cout << "Vertex: " << i << ":\n";
 
-        for (const auto& dest : m_adjList[i]) {
-            if (m_adjList[dest].find(i) != m_adjList[dest].end()) {
+        for (int dest : neighbors(i)) {
+            if (m_adjacency.test(dest, i)) {
                 // There is an edge from dest to i as well, so it's undirected
                 std::cout << " | --- " << dest << " (undirected)" << std::endl;
             }
@@ -101,19 +197,46 @@ void Graph::printGraph() const {
     }
 }
 
+void Graph::printPAG() const {
+    auto symbol = [](EndpointMark mark, char arrow) {
+        switch (mark) {
+        case EndpointMark::Arrow:
+            return arrow;
+        case EndpointMark::Circle:
+            return 'o';
+        default:
+            return '-';
+        }
+    };
+
+    int numVertices = static_cast<int>(getNumVertices());
+    for (int a = 0; a < numVertices; ++a) {
+        for (int b = a + 1; b < numVertices; ++b) {
+            EndpointMark markAtB = m_marks.get(a, b);
+            if (markAtB == EndpointMark::None) {
+                continue;
+            }
+
+            std::cout << a << " " << symbol(m_marks.get(b, a), '<') << "-" << symbol(markAtB, '>') << " " << b << std::endl;
+        }
+    }
+}
+
 void Graph::compareGraphs(const Graph& other) const {
     std::set<std::pair<int, int>> edges1, edges2;
 
     // Collect edges from the current graph
-    for (int src = 0; src < getNumVertices(); ++src) {
-        for (int dest : getNeighbors(src)) {
+    int numVertices = static_cast<int>(getNumVertices());
+    for (int src = 0; src < numVertices; ++src) {
+        for (int dest : neighbors(src)) {
             edges1.insert({ src, dest });
         }
     }
 
     // Collect edges from the other graph
-    for (int src = 0; src < other.getNumVertices(); ++src) {
-        for (int dest : other.getNeighbors(src)) {
+    int otherNumVertices = static_cast<int>(other.getNumVertices());
+    for (int src = 0; src < otherNumVertices; ++src) {
+        for (int dest : other.neighbors(src)) {
             edges2.insert({ src, dest });
         }
     }
@@ -161,41 +284,28 @@ void Graph::compareGraphs(const Graph& other) const {
 
 std::vector<std::tuple<int, int, bool>> Graph::getEdges() const {
     std::vector<std::tuple<int, int, bool>> edges;
-    std::set<std::pair<int, int>> addedEdges;
 
-    for (int src = 0; src < m_adjList.size(); ++src) {
-        for (const auto& dest : m_adjList[src]) {
+    int numVertices = static_cast<int>(getNumVertices());
+    for (int src = 0; src < numVertices; ++src) {
+        for (int dest : neighbors(src)) {
+            bool reverse = m_adjacency.test(dest, src);
 
-            // Check if the edge or its reverse has already been added
-            if (addedEdges.find({ src, dest }) != addedEdges.end() || addedEdges.find({ dest, src }) != addedEdges.end()) {
+            // An edge present in both directions is reported once, from its lower endpoint
+            if (reverse && dest < src) {
                 continue;
             }
 
-            // Determine if the edge is directed
-            bool isDirected = hasDirectedEdge(src, dest) && !hasDirectedEdge(dest, src);
+            // Oriented unless both ends are still circles, so X <-> Z counts as oriented too
+            bool isDirected = m_marks.get(src, dest) != EndpointMark::Circle || m_marks.get(dest, src) != EndpointMark::Circle;
 
-            // Add the edge to the result
             edges.emplace_back(src, dest, isDirected);
-
-            // Mark this edge as added
-            addedEdges.insert({ src, dest });
         }
     }
     return edges;
 }
 
 bool operator==(const Graph& lhs, const Graph& rhs) {
-    if (lhs.getNumVertices() != rhs.getNumVertices()) {
-        return false;
-    }
-
-    for (size_t i = 0; i < lhs.m_adjList.size(); ++i) {
-        if (lhs.m_adjList[i] != rhs.m_adjList[i]) {
-            return false;
-        }
-    }
-
-    return true;
+    return lhs.m_adjacency == rhs.m_adjacency;
 }
 
 bool operator==(const std::shared_ptr<Graph>& lhs, const std::shared_ptr<Graph>& rhs) {
@@ -208,15 +318,13 @@ bool operator==(const std::shared_ptr<Graph>& lhs, const std::shared_ptr<Graph>&
 // Forbidden edges
 void Graph::addForbiddenEdge(int from, int to) {
     forbiddenEdges.emplace_back(from, to);
+    if (isVertex(from) && isVertex(to)) {
+        m_forbiddenIndex.set(from, to);
+    }
 }
 
 bool Graph::isForbiddenEdge(int from, int to) const {
-    for (const auto& edge : forbiddenEdges) {
-        if (edge.first == from && edge.second == to) {
-            return true;
-        }
-    }
-    return false;
+    return isVertex(from) && isVertex(to) && m_forbiddenIndex.test(from, to);
 }
 
 const std::vector<std::pair<int, int>>& Graph::getForbiddenEdges() const {
@@ -226,15 +334,13 @@ const std::vector<std::pair<int, int>>& Graph::getForbiddenEdges() const {
 // Required edges
 void Graph::addRequiredEdge(int from, int to) {
     requiredEdges.emplace_back(from, to);
+    if (isVertex(from) && isVertex(to)) {
+        m_requiredIndex.set(from, to);
+    }
 }
 
 bool Graph::isRequiredEdge(int from, int to) const {
-    for (const auto& edge : requiredEdges) {
-        if (edge.first == from && edge.second == to) {
-            return true;
-        }
-    }
-    return false;
+    return isVertex(from) && isVertex(to) && m_requiredIndex.test(from, to);
 }
 
 const std::vector<std::pair<int, int>>& Graph::getRequiredEdges() const {
@@ -244,15 +350,13 @@ const std::vector<std::pair<int, int>>& Graph::getRequiredEdges() const {
 // Direction constraints
 void Graph::addDirectionConstraint(int from, int to) {
     directionConstraints.emplace_back(from, to);
+    if (isVertex(from) && isVertex(to)) {
+        m_directionIndex.set(from, to);
+    }
 }
 
 bool Graph::hasDirectionConstraint(int from, int to) const {
-    for (const auto& constraint : directionConstraints) {
-        if (constraint.first == from && constraint.second == to) {
-            return true;
-        }
-    }
-    return false;
+    return isVertex(from) && isVertex(to) && m_directionIndex.test(from, to);
 }
 
 const std::vector<std::pair<int, int>>& Graph::getDirectionConstraints() const {
@@ -2,8 +2,9 @@
 #define GRAPH_H
 
 #include "dataset.h"
+#include "bitMatrix.h"
+#include "endpointMarkMatrix.h"
 #include <vector>
-#include <unordered_set>
 #include <memory>
 #include <algorithm>
 #include <iostream>
@@ -12,7 +13,8 @@
 class Graph
 {
 public:
-    using NeighborSet = std::unordered_set<int>;
+    // Out-neighbours of a vertex in ascending order, read straight from the adjacency bits
+    using NeighborRange = BitMatrix::RowRange;
 
     Graph() = delete;
 
@@ -30,14 +32,38 @@ public:
 
     size_t getNumVertices() const;
 
+    // Copy of the out-neighbours; use neighbors() when the graph is not modified while iterating
     std::vector<int> getNeighbors(int vertex) const;
+    NeighborRange neighbors(int vertex) const;
+    size_t getOutDegree(int vertex) const;
+
+    // Row src holds a bit for every edge src -> dest
+    const BitMatrix& getAdjacencyMatrix() const;
+
+    // PAG endpoint marks; getEndpointMark(a, b) is the mark at b on the edge between a and b.
+    // Marks and directed edges describe the same graph: an edge present in both directions
+    // reads as a o-o b, one present only as src -> dest reads as src --> dest, and an edge
+    // whose only arrowhead is at a drops the directed edge a -> b.
+    EndpointMark getEndpointMark(int from, int to) const;
+
+    // Changes one end of an existing edge in place; None removes the edge
+    void setEndpointMark(int from, int to, EndpointMark mark);
+
+    // Adds or replaces the edge between a and b
+    void setEdge(int a, int b, EndpointMark markAtA, EndpointMark markAtB);
 
     void printGraph() const;
 
+    // One line per edge with both endpoint marks, e.g. "0 o-> 2"
+    void printPAG() const;
+
     void compareGraphs(const Graph& other) const;
 
+    // Every edge once, as (src, dest, oriented). An edge is oriented unless both of its marks are
+    // circles; edges present in both directions (o-o, <->) are reported from their lower endpoint.
     std::vector<std::tuple<int, int, bool>> getEdges() const;
 
+    // Compares the directed edges only
     friend bool operator==(const Graph& lhs, const Graph& rhs);
 
     friend bool operator==(const std::shared_ptr<Graph>& lhs, const std::shared_ptr<Graph>& rhs);
@@ -58,12 +84,25 @@ public:
     const std::vector<std::pair<int, int>>& getDirectionConstraints() const;
 
 private:
-    std::vector<NeighborSet> m_adjList;
+    bool isVertex(int vertex) const;
+
+    // Recompute one side from the other after the pair (a, b) changed
+    void updateMarksFromAdjacency(int a, int b);
+    void updateAdjacencyFromMarks(int a, int b);
+
+    BitMatrix m_adjacency;
+    EndpointMarkMatrix m_marks;
     std::shared_ptr<Dataset> m_dataset;
 
     std::vector<std::pair<int, int>> forbiddenEdges;
     std::vector<std::pair<int, int>> requiredEdges;
     std::vector<std::pair<int, int>> directionConstraints;
+
+    // Constant-time lookups for the constraint lists above; constraints naming
+    // vertices outside the graph are kept in the lists but never match
+    BitMatrix m_forbiddenIndex;
+    BitMatrix m_requiredIndex;
+    BitMatrix m_directionIndex;
 };
 
 #endif // GRAPH_H
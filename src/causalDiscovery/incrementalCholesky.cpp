@@ -0,0 +1,186 @@
+#include "incrementalCholesky.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using namespace Eigen;
+
+IncrementalCholesky::IncrementalCholesky(const Dataset& data)
+    : m_ownedCrossProducts(std::make_shared<const CrossProductMatrix>(data)), m_crossProducts(m_ownedCrossProducts.get()) {
+}
+
+IncrementalCholesky::IncrementalCholesky(const CrossProductMatrix& crossProducts) : m_crossProducts(&crossProducts) {
+}
+
+IncrementalCholesky::IncrementalCholesky(const CorrelationMatrix& correlations) : m_correlations(&correlations) {
+}
+
+IncrementalCholesky IncrementalCholesky::ofColumns(const Dataset& data) {
+    if (data.getRowSelection()) {
+        throw std::invalid_argument("IncrementalCholesky reads whole columns and cannot factor a view.");
+    }
+
+    IncrementalCholesky factor;
+    factor.m_data = &data;
+    size_t numRows = data.getNumOfColumns() == 0 ? 0 : data.getColumnView(0).size();
+    factor.m_basis.resize(static_cast<Index>(numRows), 0);
+    std::span<const double> weights = data.getRowWeights();
+    if (!weights.empty()) {
+        factor.m_scale = Map<const VectorXd>(weights.data(), static_cast<Index>(weights.size())).cwiseSqrt();
+    }
+    return factor;
+}
+
+double IncrementalCholesky::crossProduct(int a, int b) const {
+    return m_correlations ? m_correlations->getCorrelation(a, b) : m_crossProducts->getCrossProduct(a, b);
+}
+
+VectorXd IncrementalCholesky::scaledColumn(int variable) const {
+    std::span<const double> values = m_data->getColumnView(variable);
+    VectorXd column = Map<const VectorXd>(values.data(), static_cast<Index>(values.size()));
+    if (m_scale.size() > 0) {
+        column.array() *= m_scale.array();
+    }
+    return column;
+}
+
+VectorXd IncrementalCholesky::project(VectorXd& x) const {
+    auto basis = m_basis.leftCols(static_cast<Index>(m_variables.size()));
+    VectorXd coefficients = basis.transpose() * x;
+    x -= basis * coefficients;
+    VectorXd correction = basis.transpose() * x;
+    x -= basis * correction;
+    return coefficients + correction;
+}
+
+void IncrementalCholesky::assign(std::span<const int> variables) {
+    size_t shared = 0;
+    while (shared < m_variables.size() && shared < variables.size() && m_variables[shared] == variables[shared]) {
+        ++shared;
+    }
+    while (m_variables.size() > shared) {
+        pop();
+    }
+    for (size_t k = shared; k < variables.size(); ++k) {
+        push(variables[k]);
+    }
+}
+
+void IncrementalCholesky::assign(const std::set<int>& variables) {
+    std::vector<int> ordered(variables.begin(), variables.end());
+    assign(std::span<const int>(ordered));
+}
+
+VectorXd IncrementalCholesky::forwardSolve(const VectorXd& rhs) const {
+    Index size = static_cast<Index>(m_variables.size());
+    VectorXd z(size);
+    for (Index a = 0; a < size; ++a) {
+        if (m_dependent[a]) {
+            z(a) = 0.0;
+            continue;
+        }
+        z(a) = (rhs(a) - m_factor.row(a).head(a).dot(z.head(a))) / m_factor(a, a);
+    }
+    return z;
+}
+
+void IncrementalCholesky::push(int variable) {
+    Index size = static_cast<Index>(m_variables.size());
+    if (size == m_factor.rows()) {
+        Index capacity = std::max<Index>(4, 2 * size);
+        m_factor.conservativeResize(capacity, capacity);
+        if (m_data) {
+            m_basis.conservativeResize(NoChange, capacity);
+        }
+    }
+
+    // The new row of L is L^-1 G_Sv, or on columns their coordinates in the basis; the
+    // pivot is what the set leaves of G_vv
+    VectorXd row;
+    VectorXd column;
+    double total;
+    double pivot;
+    if (m_data) {
+        column = scaledColumn(variable);
+        total = column.squaredNorm();
+        row = project(column);
+        pivot = column.squaredNorm();
+    }
+    else {
+        VectorXd cross(size);
+        for (Index a = 0; a < size; ++a) {
+            cross(a) = crossProduct(m_variables[a], variable);
+        }
+        row = forwardSolve(cross);
+        total = crossProduct(variable, variable);
+        pivot = total - row.squaredNorm();
+    }
+
+    // Same relative rank threshold as the pivoted QR of G_SS
+    bool dependent = !(pivot > std::numeric_limits<double>::epsilon() * (size + 1) * total);
+    m_factor.row(size).head(size) = row.transpose();
+    m_factor(size, size) = dependent ? 0.0 : std::sqrt(pivot);
+    if (m_data) {
+        m_basis.col(size) = dependent ? VectorXd::Zero(column.size()) : VectorXd(column / std::sqrt(pivot));
+    }
+
+    m_variables.push_back(variable);
+    m_dependent.push_back(dependent);
+    ++m_numPushes;
+}
+
+void IncrementalCholesky::pop() {
+    if (m_variables.empty()) {
+        throw std::out_of_range("IncrementalCholesky::pop on an empty set");
+    }
+    m_variables.pop_back();
+    m_dependent.pop_back();
+}
+
+void IncrementalCholesky::clear() {
+    m_variables.clear();
+    m_dependent.clear();
+}
+
+std::span<const int> IncrementalCholesky::getVariables() const {
+    return m_variables;
+}
+
+size_t IncrementalCholesky::getNumPushes() const {
+    return m_numPushes;
+}
+
+std::shared_ptr<ResidualStatistics> IncrementalCholesky::residualStatistics(int variable) const {
+    Index size = static_cast<Index>(m_variables.size());
+    auto statistics = std::make_shared<ResidualStatistics>();
+    if (m_data) {
+        statistics->residual = scaledColumn(variable);
+        statistics->totalSquares = statistics->residual.squaredNorm();
+        project(statistics->residual);
+        statistics->residualSquares = statistics->residual.squaredNorm();
+        return statistics;
+    }
+
+    statistics->crossProducts.resize(size);
+    for (Index a = 0; a < size; ++a) {
+        statistics->crossProducts(a) = crossProduct(m_variables[a], variable);
+    }
+
+    VectorXd z = forwardSolve(statistics->crossProducts);
+
+    // L^T c = z, backwards; dependent variables get no coefficient
+    statistics->coefficients.resize(size);
+    for (Index a = size - 1; a >= 0; --a) {
+        if (m_dependent[a]) {
+            statistics->coefficients(a) = 0.0;
+            continue;
+        }
+        double sum = z(a) - m_factor.col(a).segment(a + 1, size - a - 1).dot(statistics->coefficients.tail(size - a - 1));
+        statistics->coefficients(a) = sum / m_factor(a, a);
+    }
+
+    statistics->totalSquares = crossProduct(variable, variable);
+    statistics->residualSquares = statistics->totalSquares - z.squaredNorm();
+    return statistics;
+}
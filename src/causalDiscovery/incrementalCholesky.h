@@ -0,0 +1,91 @@
+#ifndef INCREMENTALCHOLESKY_H
+#define INCREMENTALCHOLESKY_H
+
+#include <cstddef>
+#include <memory>
+#include <set>
+#include <span>
+#include <vector>
+#include <Eigen/Dense>
+#include "correlationMatrix.h"
+#include "crossProductMatrix.h"
+#include "dataset.h"
+#include "residualCache.h"
+
+// Cholesky factor L of the Gram matrix G_SS of an ordered conditioning set, updated one
+// variable at a time. Appending a variable costs one forward solve plus its cross-products
+// with the set, read from a cross-product or correlation matrix: O(|S|^2). The skeleton
+// search enumerates subsets in lexicographic order, so consecutive sets share a prefix and
+// most tests append a single variable instead of refactoring G_SS.
+//
+// For the Regression test the factor keeps the (weighted) conditioning columns themselves,
+// orthonormalised: L is then R^T of their thin QR, appending a variable costs O(N |S|), and
+// the residual vectors are projections onto the kept columns.
+//
+// A variable that is (numerically) a combination of the ones before it gets a zero column,
+// so the residuals are still projections onto the span of the set, as with the pivoted QR.
+class IncrementalCholesky {
+public:
+    // Cross-products of data's columns, computed here and weighted if data is; views are rejected
+    explicit IncrementalCholesky(const Dataset& data);
+
+    // Entries of a cross-product matrix shared with other factors, which must outlive the factor
+    explicit IncrementalCholesky(const CrossProductMatrix& crossProducts);
+
+    // Entries of a correlation matrix, which must outlive the factor
+    explicit IncrementalCholesky(const CorrelationMatrix& correlations);
+
+    // Factor of data's conditioning columns for the Regression test; data must outlive the
+    // factor, and views are rejected
+    static IncrementalCholesky ofColumns(const Dataset& data);
+
+    // Makes the set equal to variables, keeping the longest prefix shared with the current set
+    void assign(std::span<const int> variables);
+    void assign(const std::set<int>& variables);
+
+    void push(int variable);
+    void pop();
+    void clear();
+
+    std::span<const int> getVariables() const;
+
+    // Number of variables appended since construction, for measuring reuse
+    size_t getNumPushes() const;
+
+    // What regressing variable on the current set leaves, in the form the cached tests read:
+    // G_Sv, a solution of G_SS c = G_Sv, G_vv and G_vv - G_vS c for InPlace and Covariance,
+    // the residual vector and its squared norm for a factor of columns (Regression)
+    std::shared_ptr<ResidualStatistics> residualStatistics(int variable) const;
+
+private:
+    IncrementalCholesky() = default;
+
+    double crossProduct(int a, int b) const;
+
+    // Solves L z = rhs over the first size() rows, with z = 0 for dependent variables
+    Eigen::VectorXd forwardSolve(const Eigen::VectorXd& rhs) const;
+
+    // Column v of the data, each row scaled by sqrt(w)
+    Eigen::VectorXd scaledColumn(int variable) const;
+
+    // Removes the span of the first size() basis columns from x, in two passes for accuracy,
+    // and returns the coefficients taken out
+    Eigen::VectorXd project(Eigen::VectorXd& x) const;
+
+    std::shared_ptr<const CrossProductMatrix> m_ownedCrossProducts;
+    const CrossProductMatrix* m_crossProducts = nullptr;
+    const CorrelationMatrix* m_correlations = nullptr;
+
+    // Factor of columns: the data and an orthonormal basis of the set, one column per
+    // variable (zero for dependent ones), grown along with m_factor
+    const Dataset* m_data = nullptr;
+    Eigen::VectorXd m_scale; // sqrt of the row weights; empty when unweighted
+    Eigen::MatrixXd m_basis;
+
+    std::vector<int> m_variables;
+    Eigen::MatrixXd m_factor; // lower triangle of the first m_variables.size() rows; grows by doubling
+    std::vector<bool> m_dependent;
+    size_t m_numPushes = 0;
+};
+
+#endif // INCREMENTALCHOLESKY_H
@@ -0,0 +1,241 @@
+#include "momentKernels.h"
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MOMENT_KERNELS_X86 1
+#define MOMENT_KERNELS_TARGET(features) __attribute__((target(features)))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define MOMENT_KERNELS_X86 1
+#define MOMENT_KERNELS_TARGET(features)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+void PairMoments::add(const PairMoments& other) {
+    weight += other.weight;
+    sumX += other.sumX;
+    sumY += other.sumY;
+    sumXX += other.sumXX;
+    sumYY += other.sumYY;
+    sumXY += other.sumXY;
+}
+
+void PairMoments::add(double dx, double dy, double w) {
+    weight += w;
+    sumX += w * dx;
+    sumY += w * dy;
+    sumXX += w * dx * dx;
+    sumYY += w * dy * dy;
+    sumXY += w * dx * dy;
+}
+
+double PairMoments::correlation() const {
+    double xx = sumXX - sumX * sumX / weight;
+    double yy = sumYY - sumY * sumY / weight;
+    if (!(xx > 0.0) || !(yy > 0.0)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    double xy = sumXY - sumX * sumY / weight;
+    return xy / std::sqrt(xx * yy);
+}
+
+namespace {
+
+template <bool Weighted>
+PairMoments accumulateScalar(const double* x, const double* y, const double* w, size_t n, double shiftX, double shiftY) {
+    PairMoments moments;
+    for (size_t r = 0; r < n; ++r) {
+        moments.add(x[r] - shiftX, y[r] - shiftY, Weighted ? w[r] : 1.0);
+    }
+    return moments;
+}
+
+#ifdef MOMENT_KERNELS_X86
+
+// AVX only, so that both the AVX2 and the AVX-512 kernels can inline it
+MOMENT_KERNELS_TARGET("avx")
+double horizontalSum(__m256d v) {
+    __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+
+template <bool Weighted>
+MOMENT_KERNELS_TARGET("avx2,fma")
+PairMoments accumulateAVX2(const double* x, const double* y, const double* w, size_t n, double shiftX, double shiftY) {
+    const __m256d shift_x = _mm256_set1_pd(shiftX);
+    const __m256d shift_y = _mm256_set1_pd(shiftY);
+    __m256d weight = _mm256_setzero_pd();
+    __m256d sum_x = _mm256_setzero_pd();
+    __m256d sum_y = _mm256_setzero_pd();
+    __m256d sum_xx = _mm256_setzero_pd();
+    __m256d sum_yy = _mm256_setzero_pd();
+    __m256d sum_xy = _mm256_setzero_pd();
+
+    size_t r = 0;
+    for (; r + 4 <= n; r += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + r), shift_x);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + r), shift_y);
+        __m256d wx = dx;
+        __m256d wy = dy;
+        if constexpr (Weighted) {
+            __m256d row_w = _mm256_loadu_pd(w + r);
+            weight = _mm256_add_pd(weight, row_w);
+            wx = _mm256_mul_pd(row_w, dx);
+            wy = _mm256_mul_pd(row_w, dy);
+        }
+        sum_x = _mm256_add_pd(sum_x, wx);
+        sum_y = _mm256_add_pd(sum_y, wy);
+        sum_xx = _mm256_fmadd_pd(wx, dx, sum_xx);
+        sum_yy = _mm256_fmadd_pd(wy, dy, sum_yy);
+        sum_xy = _mm256_fmadd_pd(wx, dy, sum_xy);
+    }
+
+    PairMoments moments;
+    moments.weight = Weighted ? horizontalSum(weight) : static_cast<double>(r);
+    moments.sumX = horizontalSum(sum_x);
+    moments.sumY = horizontalSum(sum_y);
+    moments.sumXX = horizontalSum(sum_xx);
+    moments.sumYY = horizontalSum(sum_yy);
+    moments.sumXY = horizontalSum(sum_xy);
+    moments.add(accumulateScalar<Weighted>(x + r, y + r, Weighted ? w + r : nullptr, n - r, shiftX, shiftY));
+    return moments;
+}
+
+// Folds the two 256-bit halves together. _mm512_reduce_add_pd, _mm512_castpd512_pd256 and
+// _mm512_extractf64x4_pd pass an undefined vector through in GCC's headers, which -Wall reports
+// as an uninitialized use; the zero-masked extract with every lane kept is the same instruction.
+MOMENT_KERNELS_TARGET("avx512f")
+double horizontalSum(__m512d v) {
+    __m256d low = _mm512_maskz_extractf64x4_pd(0xff, v, 0);
+    __m256d high = _mm512_maskz_extractf64x4_pd(0xff, v, 1);
+    return horizontalSum(_mm256_add_pd(low, high));
+}
+
+template <bool Weighted>
+MOMENT_KERNELS_TARGET("avx512f")
+PairMoments accumulateAVX512(const double* x, const double* y, const double* w, size_t n, double shiftX, double shiftY) {
+    const __m512d shift_x = _mm512_set1_pd(shiftX);
+    const __m512d shift_y = _mm512_set1_pd(shiftY);
+    __m512d weight = _mm512_setzero_pd();
+    __m512d sum_x = _mm512_setzero_pd();
+    __m512d sum_y = _mm512_setzero_pd();
+    __m512d sum_xx = _mm512_setzero_pd();
+    __m512d sum_yy = _mm512_setzero_pd();
+    __m512d sum_xy = _mm512_setzero_pd();
+
+    size_t r = 0;
+    for (; r + 8 <= n; r += 8) {
+        __m512d dx = _mm512_sub_pd(_mm512_loadu_pd(x + r), shift_x);
+        __m512d dy = _mm512_sub_pd(_mm512_loadu_pd(y + r), shift_y);
+        __m512d wx = dx;
+        __m512d wy = dy;
+        if constexpr (Weighted) {
+            __m512d row_w = _mm512_loadu_pd(w + r);
+            weight = _mm512_add_pd(weight, row_w);
+            wx = _mm512_mul_pd(row_w, dx);
+            wy = _mm512_mul_pd(row_w, dy);
+        }
+        sum_x = _mm512_add_pd(sum_x, wx);
+        sum_y = _mm512_add_pd(sum_y, wy);
+        sum_xx = _mm512_fmadd_pd(wx, dx, sum_xx);
+        sum_yy = _mm512_fmadd_pd(wy, dy, sum_yy);
+        sum_xy = _mm512_fmadd_pd(wx, dy, sum_xy);
+    }
+
+    PairMoments moments;
+    moments.weight = Weighted ? horizontalSum(weight) : static_cast<double>(r);
+    moments.sumX = horizontalSum(sum_x);
+    moments.sumY = horizontalSum(sum_y);
+    moments.sumXX = horizontalSum(sum_xx);
+    moments.sumYY = horizontalSum(sum_yy);
+    moments.sumXY = horizontalSum(sum_xy);
+    moments.add(accumulateScalar<Weighted>(x + r, y + r, Weighted ? w + r : nullptr, n - r, shiftX, shiftY));
+    return moments;
+}
+
+MomentKernel detectKernel() {
+#if defined(__GNUC__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return MomentKernel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return MomentKernel::AVX2;
+    }
+#else
+    int info[4];
+    __cpuid(info, 1);
+    bool os_saves_avx = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+    bool fma = (info[2] & (1 << 12)) != 0;
+    if (os_saves_avx) {
+        __cpuidex(info, 7, 0);
+        if ((info[1] & (1 << 16)) && (_xgetbv(0) & 0xe6) == 0xe6) {
+            return MomentKernel::AVX512;
+        }
+        if ((info[1] & (1 << 5)) && fma) {
+            return MomentKernel::AVX2;
+        }
+    }
+#endif
+    return MomentKernel::Scalar;
+}
+
+#else
+
+MomentKernel detectKernel() {
+    return MomentKernel::Scalar;
+}
+
+#endif
+
+template <bool Weighted>
+PairMoments dispatch(MomentKernel kernel, const double* x, const double* y, const double* w, size_t n, double shiftX, double shiftY) {
+    switch (kernel) {
+#ifdef MOMENT_KERNELS_X86
+    case MomentKernel::AVX512:
+        return accumulateAVX512<Weighted>(x, y, w, n, shiftX, shiftY);
+    case MomentKernel::AVX2:
+        return accumulateAVX2<Weighted>(x, y, w, n, shiftX, shiftY);
+#endif
+    default:
+        return accumulateScalar<Weighted>(x, y, w, n, shiftX, shiftY);
+    }
+}
+
+} // namespace
+
+PairMoments MomentKernels::accumulate(const double* x, const double* y, const double* w, size_t n, double shiftX, double shiftY) {
+    static const MomentKernel kernel = best();
+    return w ? dispatch<true>(kernel, x, y, w, n, shiftX, shiftY) : dispatch<false>(kernel, x, y, w, n, shiftX, shiftY);
+}
+
+PairMoments MomentKernels::accumulate(MomentKernel kernel, const double* x, const double* y, const double* w, size_t n, double shiftX, double shiftY) {
+    if (!isSupported(kernel)) {
+        throw std::invalid_argument(std::string("Moment kernel not supported on this machine: ") + name(kernel));
+    }
+    return w ? dispatch<true>(kernel, x, y, w, n, shiftX, shiftY) : dispatch<false>(kernel, x, y, w, n, shiftX, shiftY);
+}
+
+bool MomentKernels::isSupported(MomentKernel kernel) {
+    return static_cast<int>(kernel) <= static_cast<int>(best());
+}
+
+MomentKernel MomentKernels::best() {
+    static const MomentKernel kernel = detectKernel();
+    return kernel;
+}
+
+const char* MomentKernels::name(MomentKernel kernel) {
+    switch (kernel) {
+    case MomentKernel::AVX2:
+        return "AVX2";
+    case MomentKernel::AVX512:
+        return "AVX-512";
+    default:
+        return "scalar";
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef MOMENTKERNELS_H
+#define MOMENTKERNELS_H
+
+#include <cstddef>
+
+// Weighted first and second moments of a pair of columns, taken about fixed shifts.
+// Shifting by a value close to the mean (the column profile's, or any sample) keeps the
+// one-pass formulas below as accurate as the two-pass ones.
+struct PairMoments {
+    double weight = 0.0; // total weight, or row count when unweighted
+    double sumX = 0.0;
+    double sumY = 0.0;
+    double sumXX = 0.0;
+    double sumYY = 0.0;
+    double sumXY = 0.0;
+
+    // Adds another accumulation taken about the same shifts
+    void add(const PairMoments& other);
+
+    // Adds one row
+    void add(double dx, double dy, double w);
+
+    // Pearson correlation; NaN when either column has no spread
+    double correlation() const;
+};
+
+enum class MomentKernel {
+    Scalar,
+    AVX2,
+    AVX512
+};
+
+// One streaming pass over x, y and (optionally) w that yields every moment a correlation
+// needs. The AVX2 and AVX-512 variants are compiled alongside the scalar one and picked at
+// run time from what the CPU supports, so the library needs no architecture flags.
+class MomentKernels {
+public:
+    // w may be null for unit weights; dx = x - shiftX and dy = y - shiftY are accumulated
+    static PairMoments accumulate(const double* x, const double* y, const double* w, size_t n, double shiftX, double shiftY);
+
+    // A specific variant, for tests and benchmarks. Throws std::invalid_argument if the
+    // CPU or the compiler does not support it.
+    static PairMoments accumulate(MomentKernel kernel, const double* x, const double* y, const double* w, size_t n, double shiftX, double shiftY);
+
+    static bool isSupported(MomentKernel kernel);
+
+    // The widest supported variant; detected once
+    static MomentKernel best();
+
+    static const char* name(MomentKernel kernel);
+};
+
+#endif
@@ -0,0 +1,134 @@
+#include "multiFileReader.h"
+#include "CSVReader.h"
+#include "XLSXReader.h"
+#include "threadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+bool hasWildcard(const std::string& text) {
+    return text.find_first_of("*?") != std::string::npos;
+}
+
+// '*' matches any run of characters, '?' exactly one
+bool matchesWildcard(const std::string& pattern, const std::string& name) {
+    size_t p = 0;
+    size_t n = 0;
+    size_t starPattern = std::string::npos;
+    size_t starName = 0;
+
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+            ++p;
+            ++n;
+        }
+        else if (p < pattern.size() && pattern[p] == '*') {
+            starPattern = p++;
+            starName = n;
+        }
+        else if (starPattern != std::string::npos) {
+            p = starPattern + 1;
+            n = ++starName;
+        }
+        else {
+            return false;
+        }
+    }
+
+    while (p < pattern.size() && pattern[p] == '*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+bool isWorkbook(const std::string& filename) {
+    return filename.size() >= 5 && filename.compare(filename.size() - 5, 5, ".xlsx") == 0;
+}
+
+} // namespace
+
+std::vector<std::string> MultiFileReader::expandPattern(const std::string& pattern) {
+    if (!hasWildcard(pattern)) {
+        return { pattern };
+    }
+
+    std::filesystem::path path(pattern);
+    std::filesystem::path directory = path.parent_path();
+    std::string namePattern = path.filename().string();
+    if (hasWildcard(directory.string())) {
+        throw std::invalid_argument("Wildcards are only supported in the file name: " + pattern);
+    }
+
+    std::vector<std::string> matches;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory.empty() ? "." : directory, error)) {
+        if (entry.is_regular_file() && matchesWildcard(namePattern, entry.path().filename().string())) {
+            matches.push_back((directory / entry.path().filename()).string());
+        }
+    }
+
+    if (matches.empty()) {
+        throw std::invalid_argument("No files match " + pattern);
+    }
+    std::sort(matches.begin(), matches.end());
+    return matches;
+}
+
+std::vector<Column> MultiFileReader::readColumns(const std::vector<std::string>& filenames, const std::vector<std::string>& columnNames,
+    std::vector<FileLoadStats>* stats, size_t numThreads, MissingFields missing) {
+    std::vector<std::string> files;
+    for (const auto& name : filenames) {
+        auto expanded = expandPattern(name);
+        files.insert(files.end(), expanded.begin(), expanded.end());
+    }
+    if (files.empty()) {
+        throw std::invalid_argument("No files to load.");
+    }
+
+    if (numThreads == 0) {
+        numThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    // Files run side by side; whatever threads are left over parse within each CSV file
+    ThreadPool pool(std::min(numThreads, files.size()));
+    size_t threadsPerFile = std::max<size_t>(1, numThreads / files.size());
+
+    std::vector<std::vector<Column>> parts(files.size());
+    std::vector<FileLoadStats> fileStats(files.size());
+    pool.parallelFor(files.size(), [&](size_t f) {
+        auto start = std::chrono::steady_clock::now();
+        parts[f] = isWorkbook(files[f])
+            ? XLSXReader::readXLSXColumns(files[f], columnNames, "", missing)
+            : CSVReader::readCSVColumns(files[f], columnNames, threadsPerFile, missing);
+        auto end = std::chrono::steady_clock::now();
+
+        fileStats[f].filename = files[f];
+        fileStats[f].numRows = parts[f].empty() ? 0 : parts[f][0].size();
+        fileStats[f].numBytes = std::filesystem::file_size(files[f]);
+        fileStats[f].milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+    });
+
+    size_t totalRows = 0;
+    for (const auto& file : fileStats) {
+        totalRows += file.numRows;
+    }
+
+    // One allocation per output column; each file's part is released once it is copied
+    std::vector<Column> columns(columnNames.size());
+    pool.parallelFor(columns.size(), [&](size_t c) {
+        columns[c].reserve(totalRows);
+        for (auto& part : parts) {
+            columns[c].insert(columns[c].end(), part[c].begin(), part[c].end());
+            Column().swap(part[c]);
+        }
+    });
+
+    if (stats) {
+        *stats = std::move(fileStats);
+    }
+    return columns;
+}
@@ -0,0 +1,37 @@
+#ifndef MULTIFILEREADER_H
+#define MULTIFILEREADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CSVReader.h"
+#include "dataset.h"
+
+// What loading one file of a multi-file dataset cost
+struct FileLoadStats {
+    std::string filename;
+    size_t numRows = 0;
+    uint64_t numBytes = 0;
+    double milliseconds = 0.0; // wall time of parsing this file, measured on its own thread
+};
+
+// Loads datasets split over several files with the same schema, such as the monthly
+// KV-41762_2023MM exports. The files are parsed concurrently and then concatenated in the
+// order given, with every output column allocated exactly once at its final size.
+class MultiFileReader {
+public:
+    // Returns the files a pattern names, sorted. Only the file name part may contain the
+    // wildcards '*' and '?'; a pattern without them is returned as is. Throws
+    // std::invalid_argument if a wildcard pattern matches no file.
+    static std::vector<std::string> expandPattern(const std::string& pattern);
+
+    // Loads the named columns from every file, each read as readCSVColumns or, for .xlsx
+    // files, readXLSXColumns would read it. Entries of filenames may be patterns. If stats is
+    // given it receives one record per file in load order. numThreads == 0 uses every
+    // hardware thread, shared between the files.
+    static std::vector<Column> readColumns(const std::vector<std::string>& filenames, const std::vector<std::string>& columnNames,
+        std::vector<FileLoadStats>* stats = nullptr, size_t numThreads = 0, MissingFields missing = MissingFields::DropRow);
+};
+
+#endif // MULTIFILEREADER_H
@@ -0,0 +1,80 @@
+#include "possibleDSep.h"
+#include "graph.h"
+#include "bitMatrix.h"
+#include <algorithm>
+
+PossibleDSep::PossibleDSep(const Graph& graph) {
+    int numVertices = static_cast<int>(graph.getNumVertices());
+
+    BitMatrix adjacency = graph.getAdjacencyMatrix().symmetrized();
+
+    m_rowStart.assign(numVertices + 1, 0);
+    for (int a = 0; a < numVertices; ++a) {
+        m_rowStart[a] = m_targets.size();
+        for (int b : adjacency.setBits(a)) {
+            if (a == b) {
+                continue;
+            }
+
+            m_sources.push_back(a);
+            m_targets.push_back(b);
+            m_arrowAtSource.push_back(graph.getEndpointMark(b, a) == EndpointMark::Arrow);
+            m_arrowAtTarget.push_back(graph.getEndpointMark(a, b) == EndpointMark::Arrow);
+        }
+    }
+    m_rowStart[numVertices] = m_targets.size();
+
+    m_visitedEdge.assign(m_targets.size(), 0);
+    m_visitedVertex.assign(numVertices, 0);
+    m_queue.reserve(m_targets.size());
+}
+
+bool PossibleDSep::isAdjacent(int a, int b) const {
+    auto first = m_targets.begin() + m_rowStart[a];
+    auto last = m_targets.begin() + m_rowStart[a + 1];
+    return std::binary_search(first, last, b);
+}
+
+void PossibleDSep::compute(int x, std::vector<int>& result) {
+    result.clear();
+    m_queue.clear();
+
+    if (++m_stamp == 0) {
+        // Stamp wrapped around; start over with clean flags
+        std::fill(m_visitedEdge.begin(), m_visitedEdge.end(), 0);
+        std::fill(m_visitedVertex.begin(), m_visitedVertex.end(), 0);
+        m_stamp = 1;
+    }
+
+    m_visitedVertex[x] = m_stamp;
+    for (size_t e = m_rowStart[x]; e < m_rowStart[x + 1]; ++e) {
+        m_visitedEdge[e] = m_stamp;
+        m_queue.push_back(e);
+    }
+
+    for (size_t head = 0; head < m_queue.size(); ++head) {
+        size_t edge = m_queue[head];
+        int a = m_sources[edge];
+        int b = m_targets[edge];
+
+        if (m_visitedVertex[b] != m_stamp) {
+            m_visitedVertex[b] = m_stamp;
+            result.push_back(b);
+        }
+
+        for (size_t next = m_rowStart[b]; next < m_rowStart[b + 1]; ++next) {
+            int c = m_targets[next];
+            if (c == a || c == x || m_visitedEdge[next] == m_stamp) {
+                continue;
+            }
+
+            bool collider = m_arrowAtTarget[edge] && m_arrowAtSource[next];
+            if (collider || isAdjacent(a, c)) {
+                m_visitedEdge[next] = m_stamp;
+                m_queue.push_back(next);
+            }
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+}
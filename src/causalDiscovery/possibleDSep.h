@@ -0,0 +1,41 @@
+#ifndef POSSIBLEDSEP_H
+#define POSSIBLEDSEP_H
+
+#include "graph.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Possible-D-Sep(X) over the current PAG: every vertex reachable from X along a path
+// on which each inner vertex B of a subpath <A, B, C> is a collider (A *-> B <-* C)
+// or A, B and C form a triangle.
+//
+// The search is a breadth-first walk over edge states, so computing the set for one
+// vertex costs O(E * maxDegree). All buffers are sized once in the constructor and
+// reused by every compute() call.
+class PossibleDSep {
+public:
+    explicit PossibleDSep(const Graph& graph);
+
+    // Replaces result with Possible-D-Sep(x) in ascending order (x itself excluded)
+    void compute(int x, std::vector<int>& result);
+
+private:
+    bool isAdjacent(int a, int b) const;
+
+    // Adjacency snapshot in CSR form; rows are sorted
+    std::vector<size_t> m_rowStart;
+    std::vector<int> m_sources;
+    std::vector<int> m_targets;
+    std::vector<uint8_t> m_arrowAtSource;
+    std::vector<uint8_t> m_arrowAtTarget;
+
+    // Generation stamps instead of clearing flags between compute() calls
+    std::vector<uint32_t> m_visitedEdge;
+    std::vector<uint32_t> m_visitedVertex;
+    uint32_t m_stamp = 0;
+
+    std::vector<size_t> m_queue;
+};
+
+#endif // POSSIBLEDSEP_H
@@ -0,0 +1,164 @@
+#include "residualCache.h"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+size_t ResidualStatistics::bytes() const {
+    return sizeof(ResidualStatistics) + sizeof(double) * (residual.size() + coefficients.size() + crossProducts.size());
+}
+
+ResidualCache::ResidualCache(size_t maxBytes, size_t numShards) : m_shards(numShards), m_maxBytes(maxBytes) {
+    if (numShards == 0) {
+        throw std::invalid_argument("A residual cache needs at least one shard.");
+    }
+}
+
+bool ResidualCache::Key::operator==(const Key& other) const {
+    return variable == other.variable && std::ranges::equal(conditioningSet, other.conditioningSet);
+}
+
+ResidualCache::Key ResidualCache::Entry::key() const {
+    return Key{ variable, conditioningSet };
+}
+
+size_t ResidualCache::KeyHash::operator()(const Key& key) const {
+    size_t seed = std::hash<int>{}(key.variable);
+    for (int k : key.conditioningSet) {
+        seed ^= std::hash<int>{}(k) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+}
+
+size_t ResidualCache::shardIndex(const Key& key) const {
+    // The maps use the low bits of the same hash for their buckets, so pick the shard from the high ones
+    size_t mixed = static_cast<size_t>((KeyHash{}(key) * 0x9e3779b97f4a7c15ull) >> 32);
+    return mixed % m_shards.size();
+}
+
+std::shared_ptr<const ResidualStatistics> ResidualCache::lookup(int variable, std::span<const int> conditioningSet) {
+    Key key{ variable, conditioningSet };
+    Shard& shard = m_shards[shardIndex(key)];
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        ++shard.misses;
+        return nullptr;
+    }
+
+    ++shard.hits;
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    return it->second->statistics;
+}
+
+void ResidualCache::store(int variable, std::span<const int> conditioningSet, std::shared_ptr<const ResidualStatistics> statistics) {
+    size_t bytes = statistics->bytes() + sizeof(Entry);
+    size_t maxBytes = m_maxBytes.load();
+    if (bytes > maxBytes) {
+        return;
+    }
+
+    Key key{ variable, conditioningSet };
+    size_t home = shardIndex(key);
+    evictUntil(home, maxBytes - bytes);
+
+    Shard& shard = m_shards[home];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.index.count(key)) {
+        // Another thread computed the same entry first
+        return;
+    }
+
+    shard.entries.push_front(Entry{ variable, std::vector<int>(conditioningSet.begin(), conditioningSet.end()), std::move(statistics), bytes });
+    shard.index.emplace(shard.entries.front().key(), shard.entries.begin());
+    m_bytes += bytes;
+}
+
+void ResidualCache::evictUntil(size_t first, size_t maxBytes) {
+    bool evicted = true;
+    while (evicted && m_bytes.load() > maxBytes) {
+        evicted = false;
+        for (size_t k = 0; k < m_shards.size() && m_bytes.load() > maxBytes; ++k) {
+            Shard& shard = m_shards[(first + k) % m_shards.size()];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (shard.entries.empty()) {
+                continue;
+            }
+
+            Entry& last = shard.entries.back();
+            m_bytes -= last.bytes;
+            shard.index.erase(last.key());
+            shard.entries.pop_back();
+            ++shard.evictions;
+            evicted = true;
+        }
+    }
+}
+
+void ResidualCache::setMaxBytes(size_t maxBytes) {
+    m_maxBytes = maxBytes;
+    evictUntil(0, maxBytes);
+}
+
+size_t ResidualCache::getMaxBytes() const {
+    return m_maxBytes.load();
+}
+
+bool ResidualCache::isEnabled() const {
+    return getMaxBytes() > 0;
+}
+
+void ResidualCache::clear() {
+    for (Shard& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const Entry& entry : shard.entries) {
+            m_bytes -= entry.bytes;
+        }
+        shard.entries.clear();
+        shard.index.clear();
+        shard.hits = 0;
+        shard.misses = 0;
+        shard.evictions = 0;
+    }
+}
+
+size_t ResidualCache::size() const {
+    size_t total = 0;
+    for (const Shard& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.index.size();
+    }
+    return total;
+}
+
+size_t ResidualCache::getBytes() const {
+    return m_bytes.load();
+}
+
+size_t ResidualCache::getHits() const {
+    size_t total = 0;
+    for (const Shard& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.hits;
+    }
+    return total;
+}
+
+size_t ResidualCache::getMisses() const {
+    size_t total = 0;
+    for (const Shard& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.misses;
+    }
+    return total;
+}
+
+size_t ResidualCache::getEvictions() const {
+    size_t total = 0;
+    for (const Shard& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.evictions;
+    }
+    return total;
+}
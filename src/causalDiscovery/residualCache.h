@@ -0,0 +1,105 @@
+#ifndef RESIDUALCACHE_H
+#define RESIDUALCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <Eigen/Dense>
+
+// What regressing one variable v on a conditioning set S leaves behind. A test of v against
+// any partner given S needs only these and one cross-product with the partner's.
+struct ResidualStatistics {
+    Eigen::VectorXd residual;      // Regression: residual vector over the (weighted) rows
+    Eigen::VectorXd coefficients;  // InPlace and Covariance: G_SS^+ G_Sv, or R_SS^+ R_Sv
+    Eigen::VectorXd crossProducts; // InPlace: G_Sv
+    double residualSquares = 0.0;  // residual sum of squares, or residual variance
+    double totalSquares = 0.0;     // G_vv before the regression (InPlace)
+
+    size_t bytes() const;
+};
+
+// Least-recently-used store of ResidualStatistics keyed by (variable, S), bounded by a memory
+// budget. One cache serves one dataset and one CI test mode: clear it when either changes.
+// Conditioning sets are sorted ascending. Lookups compare them where they lie, and an entry
+// owns the only copy of its set, so only storing allocates.
+// Entries are handed out as shared pointers, so eviction never invalidates one in use.
+// Safe to use from several threads: entries are spread over independently locked shards by
+// the hash of their key, each with its own recency list, and the budget is shared. Eviction
+// takes the least recently used entry of one shard after another, so with more than one
+// shard the order is close to, but not exactly, least recently used overall.
+class ResidualCache {
+public:
+    static constexpr size_t DefaultMaxBytes = size_t(256) << 20;
+    static constexpr size_t DefaultNumShards = 16;
+
+    // Throws std::invalid_argument if numShards is 0
+    explicit ResidualCache(size_t maxBytes = DefaultMaxBytes, size_t numShards = DefaultNumShards);
+
+    // Null on a miss; a hit makes the entry the most recently used
+    std::shared_ptr<const ResidualStatistics> lookup(int variable, std::span<const int> conditioningSet);
+
+    // Evicts least recently used entries until the new one fits. An entry larger than the
+    // whole budget is not stored.
+    void store(int variable, std::span<const int> conditioningSet, std::shared_ptr<const ResidualStatistics> statistics);
+
+    // A budget of 0 disables the cache; shrinking it evicts immediately
+    void setMaxBytes(size_t maxBytes);
+    size_t getMaxBytes() const;
+    bool isEnabled() const;
+
+    void clear();
+
+    size_t size() const;
+    size_t getBytes() const;
+    size_t getHits() const;
+    size_t getMisses() const;
+    size_t getEvictions() const;
+
+private:
+    // The index refers to the conditioning sets held by the entries, which list nodes keep in place
+    struct Key {
+        int variable;
+        std::span<const int> conditioningSet;
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        int variable;
+        std::vector<int> conditioningSet;
+        std::shared_ptr<const ResidualStatistics> statistics;
+        size_t bytes;
+
+        Key key() const;
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> entries; // most recently used first
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+    };
+
+    size_t shardIndex(const Key& key) const;
+
+    // Evicts one shard's least recently used entry after another, starting at shard first,
+    // until at most maxBytes are held or every shard is empty. Caller holds no shard lock.
+    void evictUntil(size_t first, size_t maxBytes);
+
+    std::vector<Shard> m_shards;
+    std::atomic<size_t> m_maxBytes;
+    std::atomic<size_t> m_bytes = 0;
+};
+
+#endif // RESIDUALCACHE_H
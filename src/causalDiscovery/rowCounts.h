@@ -0,0 +1,59 @@
+#ifndef ROWCOUNTS_H
+#define ROWCOUNTS_H
+
+#include "validityBitmap.h"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// How often each row of a row selection was picked, as in a bootstrap sample. Only the
+// selected rows have a count, stored in row order, so the counts take two bytes per selected
+// row; the number of selected rows before each 64-row word of the selection locates a
+// row's count with one popcount.
+class RowCounts {
+public:
+    using Count = uint16_t;
+
+    // counts[k] is the count of the k-th row set in selection
+    RowCounts(std::shared_ptr<const ValidityBitmap> selection, std::vector<Count> counts)
+        : m_selection(std::move(selection)), m_counts(std::move(counts)) {
+        std::span<const ValidityBitmap::Word> words = m_selection->getWords();
+        m_wordStarts.reserve(words.size());
+        uint32_t start = 0;
+        for (ValidityBitmap::Word word : words) {
+            m_wordStarts.push_back(start);
+            start += static_cast<uint32_t>(std::popcount(word));
+        }
+        if (start != m_counts.size()) {
+            throw std::invalid_argument("Expected one count per selected row.");
+        }
+    }
+
+    // Highest count a row can carry
+    static constexpr size_t MaxCount = std::numeric_limits<Count>::max();
+
+    // Count of a selected row
+    size_t get(size_t row) const {
+        size_t w = row / ValidityBitmap::WordBits;
+        ValidityBitmap::Word before = m_selection->getWords()[w] & ((ValidityBitmap::Word(1) << (row % ValidityBitmap::WordBits)) - 1);
+        return m_counts[m_wordStarts[w] + std::popcount(before)];
+    }
+
+    // Counts of the selected rows of word w of the selection, in row order
+    const Count* getWordCounts(size_t w) const {
+        return m_counts.data() + m_wordStarts[w];
+    }
+
+private:
+    std::shared_ptr<const ValidityBitmap> m_selection;
+    std::vector<Count> m_counts;
+    std::vector<uint32_t> m_wordStarts; // selected rows before each word
+};
+
+#endif // ROWCOUNTS_H
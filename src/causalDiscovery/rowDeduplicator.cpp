@@ -0,0 +1,101 @@
+#include "rowDeduplicator.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace {
+
+// Bits under which equal values hash alike: all NaNs are one NaN and -0.0 is 0.0
+uint64_t canonicalBits(double value) {
+    if (std::isnan(value)) {
+        return std::bit_cast<uint64_t>(std::numeric_limits<double>::quiet_NaN());
+    }
+    return std::bit_cast<uint64_t>(value == 0.0 ? 0.0 : value);
+}
+
+// Final mix of splitmix64, so nearby values spread over the whole table
+uint64_t mix(uint64_t hash) {
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ull;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebull;
+    return hash ^ (hash >> 31);
+}
+
+} // namespace
+
+std::shared_ptr<Dataset> RowDeduplicator::deduplicate(const Dataset& data, DatasetStorage storage) {
+    size_t numColumns = data.getNumOfColumns();
+    std::vector<std::span<const double>> columns(numColumns);
+    for (size_t c = 0; c < numColumns; ++c) {
+        columns[c] = data.getStoredColumnView(static_cast<int>(c));
+    }
+    size_t numRows = numColumns == 0 ? 0 : columns[0].size();
+    std::span<const double> inputWeights = data.getRowWeights();
+    const ValidityBitmap* selection = data.getRowSelection();
+    const RowCounts* counts = data.getRowCounts();
+
+    auto rowHash = [&](size_t row) {
+        uint64_t hash = 14695981039346656037ull;
+        for (const auto& column : columns) {
+            hash = mix(hash ^ canonicalBits(column[row]));
+        }
+        return hash;
+    };
+    auto sameRow = [&](size_t a, size_t b) {
+        for (const auto& column : columns) {
+            if (canonicalBits(column[a]) != canonicalBits(column[b])) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Open addressing with linear probing; a slot holds 1 + the index of a unique row
+    size_t capacity = std::bit_ceil(std::max<size_t>(16, numRows * 2));
+    std::vector<uint32_t> slots(capacity, 0);
+    std::vector<uint64_t> uniqueHashes;
+    std::vector<size_t> uniqueRows;
+    Column weights;
+
+    for (size_t row = 0; row < numRows; ++row) {
+        if (selection && !selection->isValid(row)) {
+            continue;
+        }
+        uint64_t hash = rowHash(row);
+        double weight = inputWeights.empty() ? 1.0 : inputWeights[row];
+        if (counts) {
+            weight *= counts->get(row);
+        }
+
+        size_t slot = hash & (capacity - 1);
+        while (true) {
+            uint32_t entry = slots[slot];
+            if (entry == 0) {
+                slots[slot] = static_cast<uint32_t>(uniqueRows.size() + 1);
+                uniqueHashes.push_back(hash);
+                uniqueRows.push_back(row);
+                weights.push_back(weight);
+                break;
+            }
+            if (uniqueHashes[entry - 1] == hash && sameRow(uniqueRows[entry - 1], row)) {
+                weights[entry - 1] += weight;
+                break;
+            }
+            slot = (slot + 1) & (capacity - 1);
+        }
+    }
+
+    std::vector<Column> unique(numColumns, Column(uniqueRows.size()));
+    for (size_t c = 0; c < numColumns; ++c) {
+        for (size_t u = 0; u < uniqueRows.size(); ++u) {
+            unique[c][u] = columns[c][uniqueRows[u]];
+        }
+    }
+
+    return std::make_shared<Dataset>(std::move(unique), std::move(weights), storage);
+}
@@ -0,0 +1,20 @@
+#ifndef ROWDEDUPLICATOR_H
+#define ROWDEDUPLICATOR_H
+
+#include <memory>
+#include "dataset.h"
+
+// Collapses repeated rows into one row with a frequency weight. Rows are hashed over every
+// column of the dataset, so load only the analysed columns first. Weighted statistics over
+// the result equal the unweighted ones over the input, while each CI test reads only the
+// unique rows.
+class RowDeduplicator {
+public:
+    // Unique rows keep the order of their first occurrence. A row's weight is the number of
+    // input rows equal to it, or the sum of their weights if the input is already weighted.
+    // NaN is treated as equal to NaN, and -0.0 as equal to 0.0. A view contributes its
+    // selected rows only, so deduplicating a view materialises it.
+    static std::shared_ptr<Dataset> deduplicate(const Dataset& data, DatasetStorage storage = DatasetStorage::Columns);
+};
+
+#endif // ROWDEDUPLICATOR_H
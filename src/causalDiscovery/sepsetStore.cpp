@@ -0,0 +1,55 @@
+#include "sepsetStore.h"
+#include <algorithm>
+#include <stdexcept>
+
+void SepsetStore::reset(size_t numVertices) {
+    m_numVertices = numVertices;
+    m_numRecorded = 0;
+    size_t numPairs = numVertices < 2 ? 0 : numVertices * (numVertices - 1) / 2;
+    m_offsets.assign(numPairs, NoSepset);
+    m_sizes.assign(numPairs, 0);
+    m_members.clear();
+}
+
+size_t SepsetStore::pairIndex(int i, int j) const {
+    if (i == j || i < 0 || j < 0 || static_cast<size_t>(i) >= m_numVertices || static_cast<size_t>(j) >= m_numVertices) {
+        throw std::out_of_range("Invalid vertex pair in SepsetStore");
+    }
+
+    size_t a = static_cast<size_t>(std::min(i, j));
+    size_t b = static_cast<size_t>(std::max(i, j));
+    return a * (2 * m_numVertices - a - 1) / 2 + (b - a - 1);
+}
+
+void SepsetStore::record(int i, int j, const std::set<int>& sepset) {
+    size_t index = pairIndex(i, j);
+    if (m_offsets[index] == NoSepset) {
+        ++m_numRecorded;
+    }
+
+    // A re-recorded pair leaves its previous members unused in the buffer
+    m_offsets[index] = static_cast<uint32_t>(m_members.size());
+    m_sizes[index] = static_cast<uint32_t>(sepset.size());
+    m_members.insert(m_members.end(), sepset.begin(), sepset.end());
+}
+
+bool SepsetStore::hasSepset(int i, int j) const {
+    return m_offsets[pairIndex(i, j)] != NoSepset;
+}
+
+bool SepsetStore::contains(int i, int j, int k) const {
+    auto sepset = getSepset(i, j);
+    return std::binary_search(sepset.begin(), sepset.end(), k);
+}
+
+std::span<const int> SepsetStore::getSepset(int i, int j) const {
+    size_t index = pairIndex(i, j);
+    if (m_offsets[index] == NoSepset) {
+        return {};
+    }
+    return std::span<const int>(m_members.data() + m_offsets[index], m_sizes[index]);
+}
+
+size_t SepsetStore::size() const {
+    return m_numRecorded;
+}
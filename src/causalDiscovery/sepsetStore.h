@@ -0,0 +1,39 @@
+#ifndef SEPSETSTORE_H
+#define SEPSETSTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <span>
+#include <vector>
+
+// Separation sets recorded while the skeleton is built, one slot per unordered pair.
+// Members of all sets share one flat buffer; a slot only holds its offset and size.
+class SepsetStore {
+public:
+    void reset(size_t numVertices);
+
+    void record(int i, int j, const std::set<int>& sepset);
+
+    bool hasSepset(int i, int j) const;
+
+    // True if k separated i and j. Requires hasSepset(i, j).
+    bool contains(int i, int j, int k) const;
+
+    std::span<const int> getSepset(int i, int j) const;
+
+    size_t size() const;
+
+private:
+    static constexpr uint32_t NoSepset = UINT32_MAX;
+
+    size_t pairIndex(int i, int j) const;
+
+    size_t m_numVertices = 0;
+    size_t m_numRecorded = 0;
+    std::vector<uint32_t> m_offsets;
+    std::vector<uint32_t> m_sizes;
+    std::vector<int> m_members;
+};
+
+#endif // SEPSETSTORE_H
@@ -1,107 +1,823 @@
 #include "statistic.h"
 #include "dataset.h"
+#include "momentKernels.h"
+#include <boost/math/distributions/normal.hpp>
 #include <boost/math/distributions/students_t.hpp>
 #include <Eigen/Dense>
 #include <Eigen/QR>
+#include <array>
+#include <bit>
 #include <numeric>
 #include <limits>
+#include <span>
 #include <stdexcept>
 #include <iostream>
 #include <vector>
-#include <set>
 
 using namespace Eigen;
 using namespace std;
 
-double Statistic::testConditionalIndependence(const shared_ptr<const Dataset>& data, int i, int j, const set<int>& conditioningSet) {
+double Statistic::testConditionalIndependence(const shared_ptr<const Dataset>& data, int i, int j, span<const int> conditioningSet, CITestStatistic statistic, const CriticalCorrelation* decision) {
     auto [col_i, col_j] = retrieveAndValidateData(data, i, j);
-    size_t num_rows = col_i.size();
+    size_t num_rows = data->getSampleSize();
     size_t num_conditioning_cols = conditioningSet.size();
 
+    if (num_conditioning_cols > 0 && num_rows <= num_conditioning_cols + 2) {
+        throw runtime_error("Not enough rows to form a valid X matrix.");
+    }
+
+    double p_value;
+    if (isDegenerate(*data, i, j, conditioningSet, p_value)) {
+        return p_value;
+    }
+
+    // A view selects rows of shared columns: the in-place kernels fit the same regression over them
+    if (data->getRowSelection()) {
+        return testConditionalIndependenceInPlace(*data, i, j, conditioningSet, statistic, decision);
+    }
+
     if (num_conditioning_cols == 0) {
-        return handleNoConditioning(col_i, col_j);
+        return handleNoConditioning(col_i, col_j, data->getColumnProfile(i), data->getColumnProfile(j), data->getRowWeights(), statistic, decision);
     }
 
-    if (num_rows <= num_conditioning_cols + 2) {
-        throw runtime_error("Not enough rows to form a valid X matrix.");
+    return handleConditioning(data, i, j, conditioningSet, col_i, col_j, num_rows, num_conditioning_cols, statistic, decision);
+}
+
+namespace {
+
+// Up to this many variables (i, j and the conditioning set) the Gram matrix and its solver
+// live on the stack, so an in-place test performs no heap allocation at all
+constexpr int MaxInPlaceVariables = 16;
+
+using InPlaceMatrix = Matrix<double, Dynamic, Dynamic, ColMajor, MaxInPlaceVariables, MaxInPlaceVariables>;
+
+// Residual correlation of variables 0 and 1 after regressing both on the remaining
+// variables (no intercept, as in the design-matrix path), from their Gram matrix
+template <typename MatrixType>
+double residualCorrelationFromGram(const MatrixType& gram) {
+    // Blocks of a fixed-size Gram matrix are fixed-size too, so their QR is specialized for |S|
+    constexpr int Cond = MatrixType::RowsAtCompileTime == Dynamic ? Dynamic : MatrixType::RowsAtCompileTime - 2;
+    Index num_cond = gram.rows() - 2;
+    Block<const MatrixType, Cond, Cond> G_SS(gram, 2, 2, num_cond, num_cond);
+    Block<const MatrixType, Cond, 2> G_Sy(gram, 2, 0, num_cond, 2);
+
+    // Residual cross-products: G_yy - G_yS * G_SS^+ * G_Sy
+    auto beta = G_SS.colPivHouseholderQr().solve(G_Sy).eval();
+    Matrix2d residual = gram.template topLeftCorner<2, 2>() - G_Sy.transpose() * beta;
+
+    // The Gram matrix squares the condition number, so an exact fit only shows up to about sqrt(eps)
+    double tolerance = sqrt(numeric_limits<double>::epsilon());
+    if (residual(0, 0) <= tolerance * gram(0, 0) || residual(1, 1) <= tolerance * gram(1, 1)) {
+        return 1.0;
+    }
+
+    return residual(0, 1) / sqrt(residual(0, 0) * residual(1, 1));
+}
+
+// weights, if not empty, scale each row's contribution to the cross-products
+template <typename MatrixType>
+double gramResidualCorrelation(span<const span<const double>> columns, span<const double> weights) {
+    Index num_vars = static_cast<Index>(columns.size());
+    Index num_rows = static_cast<Index>(columns[0].size());
+    Map<const VectorXd> weight(weights.data(), static_cast<Index>(weights.size()));
+
+    MatrixType gram(num_vars, num_vars);
+    for (Index a = 0; a < num_vars; ++a) {
+        Map<const VectorXd> col_a(columns[a].data(), num_rows);
+        for (Index b = a; b < num_vars; ++b) {
+            Map<const VectorXd> col_b(columns[b].data(), num_rows);
+            gram(a, b) = weights.empty() ? col_a.dot(col_b) : col_a.cwiseProduct(weight).dot(col_b);
+            gram(b, a) = gram(a, b);
+        }
+    }
+
+    return residualCorrelationFromGram(gram);
+}
+
+// gramResidualCorrelation with a Gram matrix of fixed size for up to 4 conditioning
+// variables, the dynamic-size stack matrix up to MaxInPlaceVariables, and the heap beyond
+double inPlaceResidualCorrelation(span<const span<const double>> columns, span<const double> weights) {
+    switch (columns.size()) {
+    case 3:
+        return gramResidualCorrelation<Matrix3d>(columns, weights);
+    case 4:
+        return gramResidualCorrelation<Matrix4d>(columns, weights);
+    case 5:
+        return gramResidualCorrelation<Matrix<double, 5, 5>>(columns, weights);
+    case 6:
+        return gramResidualCorrelation<Matrix<double, 6, 6>>(columns, weights);
+    default:
+        if (columns.size() <= MaxInPlaceVariables) {
+            return gramResidualCorrelation<InPlaceMatrix>(columns, weights);
+        }
+        return gramResidualCorrelation<MatrixXd>(columns, weights);
+    }
+}
+
+// Calls visit(firstRow, mask) for every 64-row block that has rows valid in all columns;
+// bit b of mask stands for row firstRow + b. A null bitmap is a column without missing values.
+template <typename Visitor>
+void forEachValidBlock(size_t num_rows, span<const ValidityBitmap* const> validity, Visitor&& visit) {
+    size_t num_words = ValidityBitmap::numWords(num_rows);
+    for (size_t w = 0; w < num_words; ++w) {
+        ValidityBitmap::Word mask = ValidityBitmap::fullWord(num_rows, w);
+        for (const ValidityBitmap* bitmap : validity) {
+            if (bitmap) {
+                mask &= bitmap->getWords()[w];
+            }
+        }
+        if (mask) {
+            visit(w * ValidityBitmap::WordBits, mask);
+        }
+    }
+}
+
+// Weight of a row; an empty weight vector counts every row once, and a view's repeated rows
+// count as often as they were picked
+double rowWeight(span<const double> weights, const RowCounts* counts, size_t row) {
+    double weight = weights.empty() ? 1.0 : weights[row];
+    return counts ? weight * counts->get(row) : weight;
+}
+
+// Weights of the 64 rows of a full block starting at first, or null when every row counts
+// once. With counts they are formed in buffer, as the view stores no weight per row.
+const double* blockWeights(span<const double> weights, const RowCounts* counts, size_t first, double* buffer) {
+    if (!counts) {
+        return weights.empty() ? nullptr : weights.data() + first;
+    }
+    const RowCounts::Count* count = counts->getWordCounts(first / ValidityBitmap::WordBits);
+    for (size_t r = 0; r < ValidityBitmap::WordBits; ++r) {
+        buffer[r] = (weights.empty() ? 1.0 : weights[first + r]) * count[r];
+    }
+    return buffer;
+}
+
+// Pearson correlation of columns[0] and columns[1] over the rows valid in both, in one pass.
+// Runs of full blocks go to the fused moment kernel; partial blocks visit their valid rows.
+// num_valid receives the number of observations those rows stand for.
+double maskedCorrelation(span<const span<const double>> columns, span<const ValidityBitmap* const> validity, span<const double> weights, const RowCounts* counts, size_t& num_valid) {
+    const double* x = columns[0].data();
+    const double* y = columns[1].data();
+    const double* w = weights.empty() ? nullptr : weights.data();
+
+    // Moments are taken about the first valid row, which keeps the one-pass sums accurate
+    PairMoments moments;
+    double shift_x = 0.0;
+    double shift_y = 0.0;
+    bool shifted = false;
+    size_t run_first = 0;
+    size_t run_end = 0;
+    auto flushRun = [&]() {
+        if (run_end > run_first) {
+            moments.add(MomentKernels::accumulate(x + run_first, y + run_first, w ? w + run_first : nullptr, run_end - run_first, shift_x, shift_y));
+        }
+        run_first = run_end = 0;
+    };
+    forEachValidBlock(columns[0].size(), validity, [&](size_t first, ValidityBitmap::Word mask) {
+        if (!shifted) {
+            size_t row = first + countr_zero(mask);
+            shift_x = x[row];
+            shift_y = y[row];
+            shifted = true;
+        }
+        if (mask == ~ValidityBitmap::Word(0) && counts) {
+            // The block's weights are formed per block, so runs of them are not merged
+            flushRun();
+            array<double, ValidityBitmap::WordBits> buffer;
+            moments.add(MomentKernels::accumulate(x + first, y + first, blockWeights(weights, counts, first, buffer.data()), ValidityBitmap::WordBits, shift_x, shift_y));
+            return;
+        }
+        if (mask == ~ValidityBitmap::Word(0)) {
+            if (first != run_end || run_end == 0) {
+                flushRun();
+                run_first = first;
+            }
+            run_end = first + ValidityBitmap::WordBits;
+            return;
+        }
+        flushRun();
+        for (; mask; mask &= mask - 1) {
+            size_t row = first + countr_zero(mask);
+            moments.add(x[row] - shift_x, y[row] - shift_y, rowWeight(weights, counts, row));
+        }
+    });
+    flushRun();
+
+    num_valid = static_cast<size_t>(moments.weight);
+    if (num_valid < 3) {
+        return numeric_limits<double>::quiet_NaN();
     }
+    return moments.correlation();
+}
+
+// gramResidualCorrelation over the rows valid in every column. Full blocks take the
+// contiguous dot products of the dense path; partial blocks visit their valid rows only.
+template <typename MatrixType>
+double maskedGramResidualCorrelation(span<const span<const double>> columns, span<const ValidityBitmap* const> validity, span<const double> weights, const RowCounts* counts, size_t& num_valid) {
+    Index num_vars = static_cast<Index>(columns.size());
+    constexpr Index BlockRows = static_cast<Index>(ValidityBitmap::WordBits);
+
+    MatrixType gram = MatrixType::Zero(num_vars, num_vars);
+    double total = 0.0;
+    forEachValidBlock(columns[0].size(), validity, [&](size_t first, ValidityBitmap::Word mask) {
+        if (mask == ~ValidityBitmap::Word(0)) {
+            array<double, ValidityBitmap::WordBits> buffer;
+            const double* w = blockWeights(weights, counts, first, buffer.data());
+            Map<const VectorXd> block_w(w, w ? BlockRows : 0);
+            total += w ? block_w.sum() : BlockRows;
+            for (Index a = 0; a < num_vars; ++a) {
+                Map<const VectorXd> block_a(columns[a].data() + first, BlockRows);
+                for (Index b = a; b < num_vars; ++b) {
+                    Map<const VectorXd> block_b(columns[b].data() + first, BlockRows);
+                    gram(a, b) += w ? block_a.cwiseProduct(block_w).dot(block_b) : block_a.dot(block_b);
+                }
+            }
+            return;
+        }
+
+        for (; mask; mask &= mask - 1) {
+            size_t row = first + countr_zero(mask);
+            double w = rowWeight(weights, counts, row);
+            total += w;
+            for (Index a = 0; a < num_vars; ++a) {
+                double value_a = w * columns[a][row];
+                for (Index b = a; b < num_vars; ++b) {
+                    gram(a, b) += value_a * columns[b][row];
+                }
+            }
+        }
+    });
+    num_valid = static_cast<size_t>(total);
+
+    for (Index a = 0; a < num_vars; ++a) {
+        for (Index b = a + 1; b < num_vars; ++b) {
+            gram(b, a) = gram(a, b);
+        }
+    }
+
+    return residualCorrelationFromGram(gram);
+}
+
+// Residual correlation of i and j given the conditioning set over the rows of data's row
+// selection and, with useValidity, the rows where every involved column is valid
+double selectedResidualCorrelation(const Dataset& data, int i, int j, span<const int> conditioningSet, bool useValidity, size_t& num_valid) {
+    size_t num_columns = conditioningSet.size() + 2;
+    double residual_corr;
+    auto run = [&](auto& columns, auto& validity) {
+        columns[0] = data.getStoredColumnView(i);
+        columns[1] = data.getStoredColumnView(j);
+        size_t next = 2;
+        for (int k : conditioningSet) {
+            columns[next++] = data.getStoredColumnView(k);
+        }
+
+        size_t num_bitmaps = 0;
+        if (data.getRowSelection()) {
+            validity[num_bitmaps++] = data.getRowSelection();
+        }
+        if (useValidity) {
+            validity[num_bitmaps++] = data.getValidity(i);
+            validity[num_bitmaps++] = data.getValidity(j);
+            for (int k : conditioningSet) {
+                validity[num_bitmaps++] = data.getValidity(k);
+            }
+        }
+
+        span<const span<const double>> columnSpan(columns.data(), num_columns);
+        span<const ValidityBitmap* const> validitySpan(validity.data(), num_bitmaps);
+        span<const double> weights = data.getRowWeights();
+        const RowCounts* counts = data.getRowCounts();
+        if (num_columns == 2) {
+            residual_corr = maskedCorrelation(columnSpan, validitySpan, weights, counts, num_valid);
+        }
+        else if (num_columns <= MaxInPlaceVariables) {
+            residual_corr = maskedGramResidualCorrelation<InPlaceMatrix>(columnSpan, validitySpan, weights, counts, num_valid);
+        }
+        else {
+            residual_corr = maskedGramResidualCorrelation<MatrixXd>(columnSpan, validitySpan, weights, counts, num_valid);
+        }
+    };
 
-    return handleConditioning(data, i, j, conditioningSet, col_i, col_j, num_rows, num_conditioning_cols);
+    if (num_columns <= MaxInPlaceVariables) {
+        array<span<const double>, MaxInPlaceVariables> columns;
+        array<const ValidityBitmap*, MaxInPlaceVariables + 1> validity;
+        run(columns, validity);
+    }
+    else {
+        vector<span<const double>> columns(num_columns);
+        vector<const ValidityBitmap*> validity(num_columns + 1);
+        run(columns, validity);
+    }
+    return residual_corr;
 }
 
-pair<vector<double>, vector<double>> Statistic::retrieveAndValidateData(const shared_ptr<const Dataset>& data, int i, int j) {
-    shared_ptr<Column> data_i = data->getColumn(i);
-    shared_ptr<Column> data_j = data->getColumn(j);
+} // namespace
 
-    if (!data_i || !data_j) {
+double Statistic::testConditionalIndependenceInPlace(const Dataset& data, int i, int j, span<const int> conditioningSet, CITestStatistic statistic, const CriticalCorrelation* decision) {
+    int num_vars = static_cast<int>(data.getNumOfColumns());
+    if (i < 0 || i >= num_vars || j < 0 || j >= num_vars) {
         throw runtime_error("Invalid column data.");
     }
 
-    vector<double> col_i(data_i->begin(), data_i->end());
-    vector<double> col_j(data_j->begin(), data_j->end());
+    span<const double> col_i = data.getStoredColumnView(i);
+    span<const double> col_j = data.getStoredColumnView(j);
+    span<const double> weights = data.getRowWeights();
+    size_t num_stored_rows = col_i.size();
+    size_t num_rows = data.getSampleSize();
+    size_t num_conditioning_cols = conditioningSet.size();
 
-    if (isConstant(col_i) || isConstant(col_j)) {
-        // cerr << "One of the variables is constant: " << (isConstant(col_i) ? "i" : "j") << endl;
+    if (col_j.size() != num_stored_rows) {
+        throw runtime_error("All columns must have the same number of rows.");
     }
 
-    return { col_i, col_j };
+    if (num_conditioning_cols > 0 && num_rows <= num_conditioning_cols + 2) {
+        throw runtime_error("Not enough rows to form a valid X matrix.");
+    }
+
+    double p_value;
+    if (isDegenerate(data, i, j, conditioningSet, p_value)) {
+        return p_value;
+    }
+
+    if (num_conditioning_cols == 0 && !data.getRowSelection()) {
+        return handleNoConditioning(col_i, col_j, data.getColumnProfile(i), data.getColumnProfile(j), weights, statistic, decision);
+    }
+
+    for (int k : conditioningSet) {
+        if (data.getStoredColumnView(k).size() != num_stored_rows) {
+            throw runtime_error("Invalid column data.");
+        }
+    }
+
+    // Views visit the selected rows only, a 64-row word of the selection at a time
+    if (data.getRowSelection()) {
+        size_t num_valid = 0;
+        double residual_corr = selectedResidualCorrelation(data, i, j, conditioningSet, false, num_valid);
+        if (std::isnan(residual_corr)) {
+            return 1.0;
+        }
+        return residualCorrelationPValue(residual_corr, num_rows, num_conditioning_cols, statistic, decision);
+    }
+
+    double residual_corr;
+    size_t num_columns = num_conditioning_cols + 2;
+    if (num_columns <= MaxInPlaceVariables) {
+        array<span<const double>, MaxInPlaceVariables> columns = { col_i, col_j };
+        size_t next = 2;
+        for (int k : conditioningSet) {
+            columns[next++] = data.getColumnView(k);
+        }
+        residual_corr = inPlaceResidualCorrelation(span<const span<const double>>(columns.data(), num_columns), weights);
+    }
+    else {
+        vector<span<const double>> columns = { col_i, col_j };
+        for (int k : conditioningSet) {
+            columns.push_back(data.getColumnView(k));
+        }
+        residual_corr = inPlaceResidualCorrelation(columns, weights);
+    }
+
+    return residualCorrelationPValue(residual_corr, num_rows, num_conditioning_cols, statistic, decision);
 }
 
-bool Statistic::isConstant(const vector<double>& vec) {
-    return all_of(vec.begin(), vec.end(), [&](double val) { return val == vec[0]; });
+bool Statistic::hasMissingValues(const Dataset& data, int i, int j, span<const int> conditioningSet) {
+    if (data.getValidity(i) || data.getValidity(j)) {
+        return true;
+    }
+    for (int k : conditioningSet) {
+        if (data.getValidity(k)) {
+            return true;
+        }
+    }
+    return false;
 }
 
-double Statistic::handleNoConditioning(const vector<double>& col_i, const vector<double>& col_j) {
-    size_t num_rows = col_i.size();
-    VectorXd vec_i = Eigen::Map<const VectorXd>(col_i.data(), col_i.size());
-    VectorXd vec_j = Eigen::Map<const VectorXd>(col_j.data(), col_j.size());
+double Statistic::testConditionalIndependenceTestWise(const Dataset& data, int i, int j, span<const int> conditioningSet, CITestStatistic statistic, const CriticalCorrelation* decision) {
+    int num_vars = static_cast<int>(data.getNumOfColumns());
+    if (i < 0 || i >= num_vars || j < 0 || j >= num_vars) {
+        throw runtime_error("Invalid column data.");
+    }
+    for (int k : conditioningSet) {
+        if (k < 0 || k >= num_vars) {
+            throw runtime_error("Invalid column data.");
+        }
+    }
+
+    if (!hasMissingValues(data, i, j, conditioningSet)) {
+        return testConditionalIndependenceInPlace(data, i, j, conditioningSet, statistic, decision);
+    }
 
-    double mean_i = vec_i.mean();
-    double mean_j = vec_j.mean();
-    double stdev_i = sqrt((vec_i.array() - mean_i).square().sum() / (vec_i.size() - 1));
-    double stdev_j = sqrt((vec_j.array() - mean_j).square().sum() / (vec_j.size() - 1));
+    size_t num_valid = 0;
+    double residual_corr = selectedResidualCorrelation(data, i, j, conditioningSet, true, num_valid);
 
-    if (stdev_i == 0 || stdev_j == 0) {
+    // Too few complete rows, or a constant column among them: no evidence of dependence
+    if (num_valid <= conditioningSet.size() + 2 || std::isnan(residual_corr)) {
         return 1.0;
     }
 
-    double corr = (vec_i.dot(vec_j) - num_rows * mean_i * mean_j) / ((num_rows - 1) * stdev_i * stdev_j);
-    if (std::isnan(corr) || std::isinf(corr)) {
+    return residualCorrelationPValue(residual_corr, num_valid, conditioningSet.size(), statistic, decision);
+}
+
+double Statistic::testConditionalIndependence(const CorrelationMatrix& correlations, int i, int j, span<const int> conditioningSet, CITestStatistic statistic, const CriticalCorrelation* decision) {
+    int num_vars = static_cast<int>(correlations.getNumVariables());
+    if (i < 0 || i >= num_vars || j < 0 || j >= num_vars) {
+        throw runtime_error("Invalid column data.");
+    }
+
+    size_t num_rows = correlations.getNumRows();
+    size_t num_conditioning_cols = conditioningSet.size();
+
+    if (correlations.isConstant(i) || correlations.isConstant(j)) {
         return 1.0;
     }
 
-    double t_statistic = corr * sqrt((num_rows - 2) / (1 - corr * corr));
-    if (std::isnan(t_statistic) || std::isinf(t_statistic)) {
-        return 1e-10; // Return a very small p-value indicating dependence
+    if (num_conditioning_cols > 0 && num_rows <= num_conditioning_cols + 2) {
+        throw runtime_error("Not enough rows to form a valid X matrix.");
     }
 
-    return computePValue(t_statistic, num_rows, 0);
+    for (int k : conditioningSet) {
+        if (k < 0 || k >= num_vars) {
+            throw runtime_error("Invalid column data.");
+        }
+        if (correlations.isConstant(k)) {
+            return 1e-10; // Same convention as the regression path for constant conditioning columns
+        }
+    }
+
+    double corr = correlations.partialCorrelation(i, j, conditioningSet);
+    return residualCorrelationPValue(corr, num_rows, num_conditioning_cols, statistic, decision);
+}
+
+namespace {
+
+using ResidualPair = pair<shared_ptr<const ResidualStatistics>, shared_ptr<const ResidualStatistics>>;
+
+// Residual statistics of i and j given the conditioning set from the cache. The missing ones
+// come from a single call compute(variables), so i and j share one regression on S.
+template <typename Compute>
+ResidualPair cachedResiduals(ResidualCache& cache, int i, int j, span<const int> conditioningSet, Compute&& compute) {
+    ResidualPair residuals = { cache.lookup(i, conditioningSet), cache.lookup(j, conditioningSet) };
+    if (residuals.first && residuals.second) {
+        return residuals;
+    }
+
+    array<int, 2> missing;
+    size_t num_missing = 0;
+    if (!residuals.first) {
+        missing[num_missing++] = i;
+    }
+    if (!residuals.second) {
+        missing[num_missing++] = j;
+    }
+
+    vector<shared_ptr<const ResidualStatistics>> computed = compute(span<const int>(missing.data(), num_missing));
+    for (size_t m = 0; m < num_missing; ++m) {
+        cache.store(missing[m], conditioningSet, computed[m]);
+    }
+
+    size_t next = 0;
+    if (!residuals.first) {
+        residuals.first = computed[next++];
+    }
+    if (!residuals.second) {
+        residuals.second = computed[next++];
+    }
+    return residuals;
 }
-double Statistic::handleConditioning(const shared_ptr<const Dataset>& data, int i, int j, const set<int>& conditioningSet, const vector<double>& col_i, const vector<double>& col_j, size_t num_rows, size_t num_conditioning_cols) {
-    MatrixXd designMatrix(num_rows, num_conditioning_cols + 2);
-    designMatrix.col(0) = Eigen::Map<const VectorXd>(col_i.data(), col_i.size());
-    designMatrix.col(1) = Eigen::Map<const VectorXd>(col_j.data(), col_j.size());
 
-    size_t colIndex = 2;
+// Residual vectors of variables on the conditioning set from one QR decomposition of the
+// design matrix, built and weighted as in the uncached regression test
+vector<shared_ptr<const ResidualStatistics>> regressionResiduals(const Dataset& data, span<const int> conditioningSet, span<const int> variables) {
+    Index num_rows = static_cast<Index>(data.getColumnView(variables[0]).size());
+    MatrixXd X(num_rows, static_cast<Index>(conditioningSet.size()));
+    Index colIndex = 0;
     for (int k : conditioningSet) {
-        shared_ptr<Column> column_k = data->getColumn(k);
-        if (!column_k) {
+        span<const double> col_k = data.getColumnView(k);
+        X.col(colIndex++) = Map<const VectorXd>(col_k.data(), col_k.size());
+    }
+    if (X.rows() == 0) {
+        throw runtime_error("One or more matrices/vectors are empty.");
+    }
+
+    span<const double> weights = data.getRowWeights();
+    VectorXd scale;
+    if (!weights.empty()) {
+        scale = Map<const VectorXd>(weights.data(), weights.size()).cwiseSqrt();
+        X.array().colwise() *= scale.array();
+    }
+
+    ColPivHouseholderQR<MatrixXd> qr(X);
+    vector<shared_ptr<const ResidualStatistics>> residuals;
+    for (int v : variables) {
+        span<const double> col_v = data.getColumnView(v);
+        VectorXd y = Map<const VectorXd>(col_v.data(), col_v.size());
+        if (!weights.empty()) {
+            y.array() *= scale.array();
+        }
+
+        auto statistics = make_shared<ResidualStatistics>();
+        VectorXd beta = qr.solve(y);
+        statistics->residual = y - X * beta;
+        statistics->residualSquares = statistics->residual.squaredNorm();
+        residuals.push_back(std::move(statistics));
+    }
+    return residuals;
+}
+
+double crossProduct(span<const double> a, span<const double> b, span<const double> weights) {
+    Map<const VectorXd> vec_a(a.data(), a.size());
+    Map<const VectorXd> vec_b(b.data(), b.size());
+    if (weights.empty()) {
+        return vec_a.dot(vec_b);
+    }
+    return vec_a.cwiseProduct(Map<const VectorXd>(weights.data(), weights.size())).dot(vec_b);
+}
+
+// Gram-matrix form of regressionResiduals: G_SS is accumulated and decomposed once for all variables
+vector<shared_ptr<const ResidualStatistics>> gramResiduals(const Dataset& data, span<const int> conditioningSet, span<const int> variables) {
+    span<const double> weights = data.getRowWeights();
+    vector<span<const double>> conditioning;
+    for (int k : conditioningSet) {
+        conditioning.push_back(data.getColumnView(k));
+    }
+
+    Index num_cond = static_cast<Index>(conditioning.size());
+    MatrixXd gram(num_cond, num_cond);
+    for (Index a = 0; a < num_cond; ++a) {
+        for (Index b = a; b < num_cond; ++b) {
+            gram(a, b) = crossProduct(conditioning[a], conditioning[b], weights);
+            gram(b, a) = gram(a, b);
+        }
+    }
+
+    ColPivHouseholderQR<MatrixXd> qr(gram);
+    vector<shared_ptr<const ResidualStatistics>> residuals;
+    for (int v : variables) {
+        span<const double> col_v = data.getColumnView(v);
+        auto statistics = make_shared<ResidualStatistics>();
+        statistics->crossProducts.resize(num_cond);
+        for (Index a = 0; a < num_cond; ++a) {
+            statistics->crossProducts(a) = crossProduct(conditioning[a], col_v, weights);
+        }
+        statistics->coefficients = qr.solve(statistics->crossProducts);
+        statistics->totalSquares = crossProduct(col_v, col_v, weights);
+        statistics->residualSquares = statistics->totalSquares - statistics->crossProducts.dot(statistics->coefficients);
+        residuals.push_back(std::move(statistics));
+    }
+    return residuals;
+}
+
+// Regression coefficients on the conditioning set read from the correlation matrix
+vector<shared_ptr<const ResidualStatistics>> correlationResiduals(const CorrelationMatrix& correlations, span<const int> conditioningSet, span<const int> variables) {
+    span<const int> cond = conditioningSet;
+    Index num_cond = static_cast<Index>(cond.size());
+    MatrixXd R_SS(num_cond, num_cond);
+    for (Index a = 0; a < num_cond; ++a) {
+        for (Index b = 0; b < num_cond; ++b) {
+            R_SS(a, b) = correlations.getCorrelation(cond[a], cond[b]);
+        }
+    }
+
+    ColPivHouseholderQR<MatrixXd> qr(R_SS);
+    vector<shared_ptr<const ResidualStatistics>> residuals;
+    for (int v : variables) {
+        VectorXd R_Sv(num_cond);
+        for (Index a = 0; a < num_cond; ++a) {
+            R_Sv(a) = correlations.getCorrelation(cond[a], v);
+        }
+
+        auto statistics = make_shared<ResidualStatistics>();
+        statistics->coefficients = qr.solve(R_Sv);
+        statistics->residualSquares = 1.0 - R_Sv.dot(statistics->coefficients);
+        statistics->totalSquares = 1.0;
+        residuals.push_back(std::move(statistics));
+    }
+    return residuals;
+}
+
+// The same statistics from a factorization updated to the conditioning set
+vector<shared_ptr<const ResidualStatistics>> factoredResiduals(IncrementalCholesky& factor, span<const int> conditioningSet, span<const int> variables) {
+    factor.assign(conditioningSet);
+    vector<shared_ptr<const ResidualStatistics>> residuals;
+    for (int v : variables) {
+        residuals.push_back(factor.residualStatistics(v));
+    }
+    return residuals;
+}
+
+} // namespace
+
+double Statistic::testConditionalIndependence(const shared_ptr<const Dataset>& data, int i, int j, span<const int> conditioningSet, ResidualCache& cache, CITestStatistic statistic, IncrementalCholesky* factor, const CriticalCorrelation* decision) {
+    if (conditioningSet.empty() || data->getRowSelection() || (!cache.isEnabled() && !factor)) {
+        return testConditionalIndependence(data, i, j, conditioningSet, statistic, decision);
+    }
+
+    retrieveAndValidateData(data, i, j);
+    size_t num_rows = data->getSampleSize();
+    if (num_rows <= conditioningSet.size() + 2) {
+        throw runtime_error("Not enough rows to form a valid X matrix.");
+    }
+
+    double p_value;
+    if (isDegenerate(*data, i, j, conditioningSet, p_value)) {
+        return p_value;
+    }
+
+    auto [residual_i, residual_j] = cachedResiduals(cache, i, j, conditioningSet, [&](span<const int> variables) {
+        return factor ? factoredResiduals(*factor, conditioningSet, variables) : regressionResiduals(*data, conditioningSet, variables);
+    });
+
+    // Same arithmetic as computeResidualCorrelation, so without a factor the p-values match the uncached test exactly
+    double norm_i = sqrt(residual_i->residualSquares);
+    double norm_j = sqrt(residual_j->residualSquares);
+    double residual_corr = 1.0;
+    if (norm_i >= numeric_limits<double>::epsilon() && norm_j >= numeric_limits<double>::epsilon()) {
+        residual_corr = residual_i->residual.dot(residual_j->residual) / (norm_i * norm_j);
+    }
+
+    return residualCorrelationPValue(residual_corr, num_rows, conditioningSet.size(), statistic, decision);
+}
+
+double Statistic::testConditionalIndependenceInPlace(const Dataset& data, int i, int j, span<const int> conditioningSet, ResidualCache& cache, CITestStatistic statistic, IncrementalCholesky* factor, const CriticalCorrelation* decision) {
+    if (conditioningSet.empty() || data.getRowSelection() || (!cache.isEnabled() && !factor)) {
+        return testConditionalIndependenceInPlace(data, i, j, conditioningSet, statistic, decision);
+    }
+
+    int num_vars = static_cast<int>(data.getNumOfColumns());
+    if (i < 0 || i >= num_vars || j < 0 || j >= num_vars) {
+        throw runtime_error("Invalid column data.");
+    }
+
+    span<const double> col_i = data.getColumnView(i);
+    span<const double> col_j = data.getColumnView(j);
+    size_t num_rows = data.getSampleSize();
+    if (col_j.size() != col_i.size()) {
+        throw runtime_error("All columns must have the same number of rows.");
+    }
+    if (num_rows <= conditioningSet.size() + 2) {
+        throw runtime_error("Not enough rows to form a valid X matrix.");
+    }
+
+    double p_value;
+    if (isDegenerate(data, i, j, conditioningSet, p_value)) {
+        return p_value;
+    }
+    for (int k : conditioningSet) {
+        if (data.getColumnView(k).size() != col_i.size()) {
+            throw runtime_error("Invalid column data.");
+        }
+    }
+
+    auto [residual_i, residual_j] = cachedResiduals(cache, i, j, conditioningSet, [&](span<const int> variables) {
+        return factor ? factoredResiduals(*factor, conditioningSet, variables) : gramResiduals(data, conditioningSet, variables);
+    });
+
+    // G_ij - G_iS * G_SS^+ * G_Sj, with the same exact-fit tolerance as residualCorrelationFromGram
+    double cross = crossProduct(col_i, col_j, data.getRowWeights()) - residual_i->crossProducts.dot(residual_j->coefficients);
+    double tolerance = sqrt(numeric_limits<double>::epsilon());
+    double residual_corr = 1.0;
+    if (residual_i->residualSquares > tolerance * residual_i->totalSquares && residual_j->residualSquares > tolerance * residual_j->totalSquares) {
+        residual_corr = cross / sqrt(residual_i->residualSquares * residual_j->residualSquares);
+    }
+
+    return residualCorrelationPValue(residual_corr, num_rows, conditioningSet.size(), statistic, decision);
+}
+
+double Statistic::testConditionalIndependence(const CorrelationMatrix& correlations, int i, int j, span<const int> conditioningSet, ResidualCache& cache, CITestStatistic statistic, IncrementalCholesky* factor, const CriticalCorrelation* decision) {
+    if (conditioningSet.empty() || (!cache.isEnabled() && !factor)) {
+        return testConditionalIndependence(correlations, i, j, conditioningSet, statistic, decision);
+    }
+
+    int num_vars = static_cast<int>(correlations.getNumVariables());
+    if (i < 0 || i >= num_vars || j < 0 || j >= num_vars) {
+        throw runtime_error("Invalid column data.");
+    }
+    if (correlations.isConstant(i) || correlations.isConstant(j)) {
+        return 1.0;
+    }
+    if (correlations.getNumRows() <= conditioningSet.size() + 2) {
+        throw runtime_error("Not enough rows to form a valid X matrix.");
+    }
+    for (int k : conditioningSet) {
+        if (k < 0 || k >= num_vars) {
+            throw runtime_error("Invalid column data.");
+        }
+        if (correlations.isConstant(k)) {
+            return 1e-10;
+        }
+    }
+
+    auto [residual_i, residual_j] = cachedResiduals(cache, i, j, conditioningSet, [&](span<const int> variables) {
+        return factor ? factoredResiduals(*factor, conditioningSet, variables) : correlationResiduals(correlations, conditioningSet, variables);
+    });
+
+    // R_ij - R_iS * R_SS^+ * R_Sj, as in CorrelationMatrix::partialCorrelation
+    double cross = correlations.getCorrelation(i, j);
+    Index a = 0;
+    for (int k : conditioningSet) {
+        cross -= correlations.getCorrelation(i, k) * residual_j->coefficients(a++);
+    }
+
+    double corr = 1.0;
+    if (residual_i->residualSquares >= numeric_limits<double>::epsilon() && residual_j->residualSquares >= numeric_limits<double>::epsilon()) {
+        corr = cross / sqrt(residual_i->residualSquares * residual_j->residualSquares);
+    }
+
+    return residualCorrelationPValue(corr, correlations.getNumRows(), conditioningSet.size(), statistic, decision);
+}
+
+pair<span<const double>, span<const double>> Statistic::retrieveAndValidateData(const shared_ptr<const Dataset>& data, int i, int j) {
+    int num_vars = static_cast<int>(data->getNumOfColumns());
+    if (i < 0 || i >= num_vars || j < 0 || j >= num_vars) {
+        throw runtime_error("Invalid column data.");
+    }
+
+    // Views into the dataset's storage; the columns are not copied
+    span<const double> col_i = data->getStoredColumnView(i);
+    span<const double> col_j = data->getStoredColumnView(j);
+
+    return { col_i, col_j };
+}
+
+bool Statistic::isDegenerate(const Dataset& data, int i, int j, span<const int> conditioningSet, double& p_value) {
+    int num_vars = static_cast<int>(data.getNumOfColumns());
+    bool hasNaN = data.getColumnProfile(i).nanCount > 0 || data.getColumnProfile(j).nanCount > 0;
+
+    for (int k : conditioningSet) {
+        if (k < 0 || k >= num_vars) {
             throw runtime_error("Invalid column data.");
         }
-        vector<double> col_k(column_k->begin(), column_k->end());
+        if (data.getColumnProfile(k).constant) {
+            p_value = 1e-10; // A constant conditioning column makes the design matrix singular
+            return true;
+        }
+        hasNaN = hasNaN || data.getColumnProfile(k).nanCount > 0;
+    }
+
+    // NaN propagates into the correlation, which the full test reports as independence
+    if (hasNaN) {
+        p_value = 1.0;
+        return true;
+    }
+
+    if (conditioningSet.empty() && (data.getColumnProfile(i).constant || data.getColumnProfile(j).constant)) {
+        p_value = 1.0;
+        return true;
+    }
+
+    // Identical columns stay identical after any regression: perfect dependence
+    if (data.areDuplicateColumns(i, j)) {
+        p_value = 1e-10;
+        return true;
+    }
+
+    return false;
+}
+
+double Statistic::handleNoConditioning(span<const double> col_i, span<const double> col_j, const ColumnProfile& profile_i, const ColumnProfile& profile_j, span<const double> weights, CITestStatistic statistic, const CriticalCorrelation* decision) {
+    // Constant columns are answered from the profiles computed when the dataset was built
+    if (profile_i.variance == 0 || profile_j.variance == 0) {
+        return 1.0;
+    }
 
-        if (isConstant(col_k)) {
-            // cerr << "Conditioning set contains a constant column: " << k << endl;
+    // Everything else takes one fused pass over both columns, about the profile means
+    PairMoments moments = MomentKernels::accumulate(col_i.data(), col_j.data(), weights.empty() ? nullptr : weights.data(), col_i.size(), profile_i.mean, profile_j.mean);
+    size_t num_rows = static_cast<size_t>(moments.weight);
+    double corr = moments.correlation();
+    if (std::isnan(corr) || std::isinf(corr)) {
+        return 1.0;
+    }
+
+    if (decision) {
+        return decision->decide(corr, num_rows, 0);
+    }
+
+    if (statistic == CITestStatistic::FisherZ) {
+        if (abs(corr) >= 1.0 - numeric_limits<double>::epsilon()) {
             return 1e-10; // Return a very small p-value indicating dependence
         }
+        return computeFisherZPValue(corr, num_rows, 0);
+    }
 
-        designMatrix.col(colIndex) = Eigen::Map<const VectorXd>(col_k.data(), col_k.size());
-        colIndex++;
+    double t_statistic = corr * sqrt((num_rows - 2) / (1 - corr * corr));
+    if (std::isnan(t_statistic) || std::isinf(t_statistic)) {
+        return 1e-10; // Return a very small p-value indicating dependence
     }
 
-    MatrixXd X = designMatrix.block(0, 2, num_rows, num_conditioning_cols);
-    VectorXd y_i = designMatrix.col(0);
-    VectorXd y_j = designMatrix.col(1);
+    return computePValue(t_statistic, num_rows, 0);
+}
+double Statistic::handleConditioning(const shared_ptr<const Dataset>& data, int i, int j, span<const int> conditioningSet, span<const double> col_i, span<const double> col_j, size_t num_rows, size_t num_conditioning_cols, CITestStatistic statistic, const CriticalCorrelation* decision) {
+    // X is the only copy: the QR decomposition works on it in place. y_i and y_j are read from the dataset.
+    MatrixXd X(col_i.size(), num_conditioning_cols);
+    Eigen::Map<const VectorXd> y_i(col_i.data(), col_i.size());
+    Eigen::Map<const VectorXd> y_j(col_j.data(), col_j.size());
+
+    Index colIndex = 0;
+    for (int k : conditioningSet) {
+        span<const double> col_k = data->getColumnView(k);
+        X.col(colIndex) = Eigen::Map<const VectorXd>(col_k.data(), col_k.size());
+        colIndex++;
+    }
 
     if (X.rows() == 0 || X.cols() == 0 || y_i.size() == 0 || y_j.size() == 0) {
         throw runtime_error("One or more matrices/vectors are empty.");
@@ -112,14 +828,36 @@ double Statistic::handleConditioning(const shared_ptr<const Dataset>& data, int
     // cout << "y_i:" << endl << y_i.transpose() << endl;
     // cout << "y_j:" << endl << y_j.transpose() << endl;
 
+    span<const double> weights = data->getRowWeights();
+    if (!weights.empty()) {
+        // Weighted least squares: scaling row r by sqrt(w_r) counts it w_r times in every cross-product
+        VectorXd scale = Eigen::Map<const VectorXd>(weights.data(), weights.size()).cwiseSqrt();
+        X.array().colwise() *= scale.array();
+        VectorXd weighted_i = y_i.cwiseProduct(scale);
+        VectorXd weighted_j = y_j.cwiseProduct(scale);
+        return residualCorrelationPValue(computeResidualCorrelation(X, weighted_i, weighted_j), num_rows, num_conditioning_cols, statistic, decision);
+    }
+
     double residual_corr = computeResidualCorrelation(X, y_i, y_j);
     // cout << "Residual Correlation: " << residual_corr << endl;
 
+    return residualCorrelationPValue(residual_corr, num_rows, num_conditioning_cols, statistic, decision);
+}
+
+double Statistic::residualCorrelationPValue(double residual_corr, size_t num_rows, size_t num_conditioning_cols, CITestStatistic statistic, const CriticalCorrelation* decision) {
     if (abs(residual_corr) >= 1.0 - numeric_limits<double>::epsilon()) {
         // cerr << "Residuals correlation too close to 1: " << residual_corr << endl;
         return 1e-10; // Return a very small p-value indicating dependence
     }
 
+    if (decision) {
+        return decision->decide(residual_corr, num_rows, num_conditioning_cols);
+    }
+
+    if (statistic == CITestStatistic::FisherZ) {
+        return computeFisherZPValue(residual_corr, num_rows, num_conditioning_cols);
+    }
+
     double t_statistic = computeTStatistic(residual_corr, num_rows, num_conditioning_cols);
     // cout << "T-Statistic: " << t_statistic << endl;
 
@@ -130,9 +868,10 @@ double Statistic::handleConditioning(const shared_ptr<const Dataset>& data, int
     return computePValue(t_statistic, num_rows, num_conditioning_cols);
 }
 
-double Statistic::computeResidualCorrelation(const MatrixXd& X, const VectorXd& y_i, const VectorXd& y_j) {
-    VectorXd beta_i = X.colPivHouseholderQr().solve(y_i);
-    VectorXd beta_j = X.colPivHouseholderQr().solve(y_j);
+double Statistic::computeResidualCorrelation(const MatrixXd& X, const Ref<const VectorXd>& y_i, const Ref<const VectorXd>& y_j) {
+    ColPivHouseholderQR<MatrixXd> qr(X);
+    VectorXd beta_i = qr.solve(y_i);
+    VectorXd beta_j = qr.solve(y_j);
 
     VectorXd residuals_i = y_i - X * beta_i;
     VectorXd residuals_j = y_j - X * beta_j;
@@ -164,3 +903,74 @@ double Statistic::computePValue(double t_statistic, size_t num_rows, size_t num_
 
     return p_value;
 }
+
+double Statistic::computeFisherZPValue(double correlation, size_t num_rows, size_t num_conditioning_cols) {
+    if (num_rows <= num_conditioning_cols + 3) {
+        return 1.0; // Not enough rows for the Fisher-z approximation
+    }
+
+    double z = 0.5 * log((1 + correlation) / (1 - correlation)) * sqrt(static_cast<double>(num_rows - num_conditioning_cols - 3));
+    boost::math::normal dist;
+    double p_value = 2 * boost::math::cdf(boost::math::complement(dist, abs(z)));
+
+    if (std::isinf(p_value) || std::isnan(p_value)) {
+        return 1.0;
+    }
+
+    return p_value;
+}
+
+CriticalCorrelation::CriticalCorrelation(double alpha, CITestStatistic statistic) : m_alpha(alpha), m_statistic(statistic) {
+    if (!(alpha > 0.0 && alpha < 1.0)) {
+        throw invalid_argument("Significance level must lie strictly between 0 and 1.");
+    }
+}
+
+CriticalCorrelation::CriticalCorrelation(double alpha, CITestStatistic statistic, size_t num_rows, size_t max_conditioning_cols)
+    : CriticalCorrelation(alpha, statistic) {
+    m_numRows = num_rows;
+    m_critical.reserve(max_conditioning_cols + 1);
+    for (size_t k = 0; k <= max_conditioning_cols; ++k) {
+        m_critical.push_back(compute(num_rows, k));
+    }
+}
+
+double CriticalCorrelation::getAlpha() const {
+    return m_alpha;
+}
+
+CITestStatistic CriticalCorrelation::getStatistic() const {
+    return m_statistic;
+}
+
+double CriticalCorrelation::get(size_t num_rows, size_t num_conditioning_cols) const {
+    if (num_rows == m_numRows && num_conditioning_cols < m_critical.size()) {
+        return m_critical[num_conditioning_cols];
+    }
+    return compute(num_rows, num_conditioning_cols);
+}
+
+double CriticalCorrelation::compute(size_t num_rows, size_t num_conditioning_cols) const {
+    // Both statistics depend on the rows and the set size only through their difference
+    size_t dof = num_rows > num_conditioning_cols ? num_rows - num_conditioning_cols : 0;
+
+    if (m_statistic == CITestStatistic::FisherZ) {
+        // p = 2 (1 - Phi(|atanh(r)| sqrt(n - |S| - 3)))
+        if (dof > 3) {
+            double z = boost::math::quantile(boost::math::complement(boost::math::normal(), m_alpha / 2));
+            return tanh(z / sqrt(static_cast<double>(dof - 3)));
+        }
+    }
+    else if (dof > 2) {
+        // p = 2 P(T_df > |t|) with t = r sqrt(df / (1 - r^2)), df = n - |S| - 2
+        double df = static_cast<double>(dof - 2);
+        double t = boost::math::quantile(boost::math::complement(boost::math::students_t(df), m_alpha / 2));
+        return t / sqrt(df + t * t);
+    }
+    return numeric_limits<double>::infinity(); // too few rows: every test is independent
+}
+
+double CriticalCorrelation::decide(double correlation, size_t num_rows, size_t num_conditioning_cols) const {
+    // NaN compares false and is reported as independence, as the exact test does
+    return abs(correlation) >= get(num_rows, num_conditioning_cols) ? 0.0 : 1.0;
+}
@@ -2,15 +2,114 @@
 #define STATISTIC_H
 
 #include "dataset.h"
+#include "correlationMatrix.h"
+#include "incrementalCholesky.h"
+#include "residualCache.h"
 #include <memory>
-#include <set>
+#include <span>
 #include <vector>
 #include <boost/numeric/ublas/matrix.hpp>
 #include <Eigen/Dense>
 
+// Where conditional-independence tests take their data from.
+// Regression and InPlace regress on the conditioning columns as they are, without an
+// intercept, as the reference implementation does. Covariance works on the centered
+// columns, which is the regression with an intercept. Given |S| > 0 the two are different
+// tests on columns with non-zero means, and may give different p-values and graphs; without
+// a conditioning set all three compute the Pearson correlation.
+enum class CITestMode {
+    Regression, // residual regression over the raw rows on every test
+    Covariance, // partial correlations of the centered columns, from a correlation matrix computed once per dataset
+    InPlace     // the Regression test solved from the Gram matrix of the tested columns, read in place
+};
+
+// Test statistic used to turn a (partial) correlation into a p-value
+enum class CITestStatistic {
+    TStatistic,
+    FisherZ
+};
+
+// What CI tests do with rows in which a tested column is missing (NaN)
+enum class MissingValues {
+    Propagate,       // NaN reaches the statistic and the test reports independence
+    TestWiseDeletion // each test uses the rows where all of its columns hold a value
+};
+
+// Decision-only testing. Discovery only asks whether p > alpha, and for a given alpha and
+// number of degrees of freedom that is |r| < r_crit. The critical correlation of every
+// conditioning set size up to a limit is computed once, for the sample size of the run, and
+// read from a table afterwards, so a test skips the Student t (or normal) CDF. Immutable, so
+// safe to share between threads.
+class CriticalCorrelation {
+public:
+    // Nothing precomputed; every critical value is worked out on request
+    CriticalCorrelation(double alpha, CITestStatistic statistic);
+
+    // Precomputes the critical values of tests over num_rows observations given 0 to
+    // max_conditioning_cols variables
+    CriticalCorrelation(double alpha, CITestStatistic statistic, size_t num_rows, size_t max_conditioning_cols);
+
+    double getAlpha() const;
+    CITestStatistic getStatistic() const;
+
+    // |r| at which the p-value of a test over num_rows observations given
+    // num_conditioning_cols variables equals alpha; infinite when there are too few rows.
+    // Sizes outside the table, such as the row counts of test-wise deletion, are computed.
+    double get(size_t num_rows, size_t num_conditioning_cols) const;
+
+    // Stand-in for the p-value: 1.0 where the test accepts independence at alpha, 0.0 where it rejects it
+    double decide(double correlation, size_t num_rows, size_t num_conditioning_cols) const;
+
+private:
+    double compute(size_t num_rows, size_t num_conditioning_cols) const;
+
+    double m_alpha;
+    CITestStatistic m_statistic;
+    size_t m_numRows = 0;
+    std::vector<double> m_critical; // indexed by the number of conditioning variables
+};
+
+// The tests below return exact p-values unless given a CriticalCorrelation, which must use
+// the same statistic; then they return its 0.0 / 1.0 decision instead. Conditioning sets are
+// column indices sorted ascending, read where the caller keeps them.
 class Statistic {
 public:
-    static double testConditionalIndependence(const std::shared_ptr<const Dataset>& data, int i, int j, const std::set<int>& conditioningSet);
+    static double testConditionalIndependence(const std::shared_ptr<const Dataset>& data, int i, int j, std::span<const int> conditioningSet, CITestStatistic statistic = CITestStatistic::TStatistic, const CriticalCorrelation* decision = nullptr);
+
+    static double testConditionalIndependence(const CorrelationMatrix& correlations, int i, int j, std::span<const int> conditioningSet, CITestStatistic statistic = CITestStatistic::TStatistic, const CriticalCorrelation* decision = nullptr);
+
+    // Same test as the Dataset overload, but the columns are only read through views and the
+    // regression is solved from their (|S|+2)x(|S|+2) Gram matrix. Nothing is copied, and for
+    // conditioning sets of up to 14 variables nothing is allocated either.
+    static double testConditionalIndependenceInPlace(const Dataset& data, int i, int j, std::span<const int> conditioningSet, CITestStatistic statistic = CITestStatistic::TStatistic, const CriticalCorrelation* decision = nullptr);
+
+    // Test-wise deletion: the in-place test restricted to the rows where i, j and every
+    // conditioning column are valid. Those rows are found by ANDing the columns' validity
+    // bitmaps a 64-row word at a time while the Gram matrix is accumulated, so no mask or
+    // filtered column is materialised. Without missing values this is the in-place test.
+    static double testConditionalIndependenceTestWise(const Dataset& data, int i, int j, std::span<const int> conditioningSet, CITestStatistic statistic = CITestStatistic::TStatistic, const CriticalCorrelation* decision = nullptr);
+
+    // The same three tests with the regressions of i and of j on the conditioning set taken
+    // from, or added to, cache. A test then costs one cross-product of i and j once both are
+    // cached, instead of a regression per test. Unconditional tests, views and a disabled
+    // cache take the uncached path; regression p-values are identical either way.
+    // A factor, if given, is moved to the conditioning set and computes the missing
+    // regressions by updating its factorization instead of solving from scratch; it must
+    // have been built from the same data (with IncrementalCholesky::ofColumns for the
+    // regression test), and is used even when the cache is disabled. Factored p-values
+    // agree with the others to rounding when the conditioning set is well conditioned.
+    // Duplicated or collinear conditioning columns are dropped by a relative rank test,
+    // so the in-place and correlation tests still reach the same decisions. The regression
+    // test does not: where the set fits i or j exactly, it tests the rounding left in the
+    // residuals against an absolute epsilon, and a factor leaves different rounding than QR.
+    static double testConditionalIndependence(const std::shared_ptr<const Dataset>& data, int i, int j, std::span<const int> conditioningSet, ResidualCache& cache, CITestStatistic statistic = CITestStatistic::TStatistic, IncrementalCholesky* factor = nullptr, const CriticalCorrelation* decision = nullptr);
+
+    static double testConditionalIndependence(const CorrelationMatrix& correlations, int i, int j, std::span<const int> conditioningSet, ResidualCache& cache, CITestStatistic statistic = CITestStatistic::TStatistic, IncrementalCholesky* factor = nullptr, const CriticalCorrelation* decision = nullptr);
+
+    static double testConditionalIndependenceInPlace(const Dataset& data, int i, int j, std::span<const int> conditioningSet, ResidualCache& cache, CITestStatistic statistic = CITestStatistic::TStatistic, IncrementalCholesky* factor = nullptr, const CriticalCorrelation* decision = nullptr);
+
+    // Whether any of i, j and the conditioning set has a missing value
+    static bool hasMissingValues(const Dataset& data, int i, int j, std::span<const int> conditioningSet);
 
 private:
     template <typename M, typename V>
@@ -18,19 +117,25 @@ private:
 
     static Eigen::MatrixXd pseudoinverse(const Eigen::MatrixXd& X);
 
-    static std::pair<std::vector<double>, std::vector<double>> retrieveAndValidateData(const std::shared_ptr<const Dataset>& data, int i, int j);
+    static std::pair<std::span<const double>, std::span<const double>> retrieveAndValidateData(const std::shared_ptr<const Dataset>& data, int i, int j);
+
+    // Answers the test from the column profiles alone when i, j or S is degenerate
+    // (constant, NaN or duplicated columns), with the p-value the full test would return
+    static bool isDegenerate(const Dataset& data, int i, int j, std::span<const int> conditioningSet, double& p_value);
 
-    static bool isConstant(const std::vector<double>& vec);
+    static double handleNoConditioning(std::span<const double> col_i, std::span<const double> col_j, const ColumnProfile& profile_i, const ColumnProfile& profile_j, std::span<const double> weights, CITestStatistic statistic, const CriticalCorrelation* decision);
 
-    static double handleNoConditioning(const std::vector<double>& col_i, const std::vector<double>& col_j);
+    static double handleConditioning(const std::shared_ptr<const Dataset>& data, int i, int j, std::span<const int> conditioningSet, std::span<const double> col_i, std::span<const double> col_j, size_t num_rows, size_t num_conditioning_cols, CITestStatistic statistic, const CriticalCorrelation* decision);
 
-    static double handleConditioning(const std::shared_ptr<const Dataset>& data, int i, int j, const std::set<int>& conditioningSet, const std::vector<double>& col_i, const std::vector<double>& col_j, size_t num_rows, size_t num_conditioning_cols);
+    static double residualCorrelationPValue(double residual_corr, size_t num_rows, size_t num_conditioning_cols, CITestStatistic statistic, const CriticalCorrelation* decision);
 
-    static double computeResidualCorrelation(const Eigen::MatrixXd& X, const Eigen::VectorXd& y_i, const Eigen::VectorXd& y_j);
+    static double computeResidualCorrelation(const Eigen::MatrixXd& X, const Eigen::Ref<const Eigen::VectorXd>& y_i, const Eigen::Ref<const Eigen::VectorXd>& y_j);
 
     static double computeTStatistic(double correlation, size_t num_rows, size_t num_conditioning_cols);
 
     static double computePValue(double t_statistic, size_t num_rows, size_t num_conditioning_cols);
+
+    static double computeFisherZPValue(double correlation, size_t num_rows, size_t num_conditioning_cols);
 };
 
 #endif // STATISTIC_H
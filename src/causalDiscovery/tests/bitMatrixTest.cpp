@@ -0,0 +1,58 @@
+#include "bitMatrix.h"
+#include "graph.h"
+#include "dataset.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+TEST(BitMatrixTest, SetBitsAcrossWordBoundaries) {
+    BitMatrix matrix(200);
+    for (size_t col : { 0, 63, 64, 65, 127, 199 }) {
+        matrix.set(3, col);
+    }
+    matrix.clear(3, 65);
+
+    EXPECT_TRUE(matrix.test(3, 64));
+    EXPECT_FALSE(matrix.test(3, 65));
+    EXPECT_FALSE(matrix.test(4, 64));
+    EXPECT_EQ(matrix.count(3), 5u);
+    EXPECT_EQ(matrix.count(4), 0u);
+
+    auto bits = matrix.setBits(3);
+    EXPECT_EQ(vector<int>(bits.begin(), bits.end()), (vector<int>{ 0, 63, 64, 127, 199 }));
+
+    auto empty = matrix.setBits(4);
+    EXPECT_TRUE(empty.begin() == empty.end());
+}
+
+TEST(BitMatrixTest, SymmetrizedAddsReverseEdges) {
+    BitMatrix matrix(70);
+    matrix.set(1, 69);
+    matrix.set(5, 2);
+
+    BitMatrix symmetric = matrix.symmetrized();
+    EXPECT_TRUE(symmetric.test(69, 1));
+    EXPECT_TRUE(symmetric.test(2, 5));
+    EXPECT_TRUE(symmetric.test(1, 69));
+    EXPECT_FALSE(matrix.test(69, 1));
+}
+
+TEST(BitMatrixTest, GraphNeighborsComeFromTheBitRows) {
+    auto graph = make_shared<Graph>(make_shared<Dataset>(vector<Column>(100)));
+    graph->addDoubleDirectedEdge(10, 90);
+    graph->addDirectedEdge(10, 3);
+    graph->addDirectedEdge(10, 150);
+
+    auto range = graph->neighbors(10);
+    EXPECT_EQ(vector<int>(range.begin(), range.end()), (vector<int>{ 3, 90 }));
+    EXPECT_EQ(graph->getNeighbors(10), (vector<int>{ 3, 90 }));
+    EXPECT_EQ(graph->getOutDegree(10), 2u);
+    EXPECT_EQ(graph->getOutDegree(3), 0u);
+
+    auto edges = graph->getEdges();
+    ASSERT_EQ(edges.size(), 2u);
+    EXPECT_EQ(edges[0], make_tuple(10, 3, true));
+    EXPECT_EQ(edges[1], make_tuple(10, 90, false));
+}
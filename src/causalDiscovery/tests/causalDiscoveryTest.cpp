@@ -4,6 +4,9 @@
 #include "CSVReader.h"
 #include <gtest/gtest.h>
 #include <memory>
+#include <random>
+#include <tuple>
+#include <vector>
 
 class CausalDiscoveryConstraintsTest : public ::testing::Test {
 protected:
@@ -104,3 +107,81 @@ TEST_F(CausalDiscoveryConstraintsTest, ConstraintsDoNotCreateSpuriousEdgesTest)
     EXPECT_LE(edges2.size(), edges1.size() + 1) 
         << "Direction constraints should not create new edges";
 }
+
+TEST_F(CausalDiscoveryConstraintsTest, FinalOrientationKeepsBidirectedEdges) {
+    // Forbidding 2 - 3 leaves colliders at 3 from both 0 and 1, which the PAG records as 0 <-> 3 and
+    // 1 <-> 3. Orienting them by vertex index would drop an arrowhead from each.
+    auto graph = std::make_shared<Graph>(data);
+    graph->addForbiddenEdge(2, 3);
+
+    CausalDiscovery fci;
+    fci.runFCI(graph, 0.05);
+
+    for (int v : { 0, 1 }) {
+        EXPECT_EQ(graph->getEndpointMark(v, 3), EndpointMark::Arrow);
+        EXPECT_EQ(graph->getEndpointMark(3, v), EndpointMark::Arrow);
+    }
+    std::vector<std::tuple<int, int, bool>> expected = { { 0, 1, true }, { 0, 3, true }, { 1, 3, true }, { 2, 0, true } };
+    EXPECT_EQ(graph->getEdges(), expected);
+}
+
+TEST_F(CausalDiscoveryConstraintsTest, ConstrainedPairsAreNeverTested) {
+    // 1 (EnginePower) and 2 (PassingNoise) are separated when unconstrained
+    auto graph = std::make_shared<Graph>(data);
+    graph->addRequiredEdge(1, 2);
+    graph->addForbiddenEdge(2, 3);
+
+    CausalDiscovery fci;
+    fci.runFCI(graph, 0.05);
+
+    // Neither pair was decided by a CI test, so neither has a separation set
+    EXPECT_FALSE(fci.getSepsets().hasSepset(1, 2));
+    EXPECT_FALSE(fci.getSepsets().hasSepset(2, 3));
+    EXPECT_TRUE(graph->hasDirectedEdge(1, 2) || graph->hasDirectedEdge(2, 1));
+}
+
+TEST_F(CausalDiscoveryConstraintsTest, DecisionOnlyModeFindsTheSameGraph) {
+    for (auto statistic : { CITestStatistic::TStatistic, CITestStatistic::FisherZ }) {
+        auto expected = std::make_shared<Graph>(data);
+        CausalDiscovery exact;
+        exact.setCITestStatistic(statistic);
+        exact.runFCI(expected, 0.05);
+
+        auto graph = std::make_shared<Graph>(data);
+        CausalDiscovery decisionOnly;
+        decisionOnly.setCITestStatistic(statistic);
+        decisionOnly.setDecisionOnly(true);
+        decisionOnly.runFCI(graph, 0.05);
+
+        EXPECT_EQ(graph->getEdges(), expected->getEdges());
+    }
+}
+
+TEST(CausalDiscoveryPossibleDSepTest, RemovesEdgeSeparatedOnlyByPossibleDSep) {
+    // A -> B -> C and D -> E, with latent confounders of A and D, of C and D, and of B and E.
+    // C and E are separated only given {A, B, D}, and A is adjacent to neither of them, so the
+    // skeleton keeps C *-* E and only the Possible-D-Sep step can remove it.
+    std::mt19937 rng(3);
+    std::normal_distribution<double> noise(0.0, 1.0);
+
+    const size_t numRows = 5000;
+    Column a(numRows), b(numRows), c(numRows), d(numRows), e(numRows);
+    for (size_t r = 0; r < numRows; ++r) {
+        double ad = noise(rng), cd = noise(rng), be = noise(rng);
+        a[r] = ad + noise(rng);
+        b[r] = 0.8 * a[r] + be + noise(rng);
+        c[r] = 0.8 * b[r] + cd + noise(rng);
+        d[r] = ad + cd + noise(rng);
+        e[r] = 0.8 * d[r] + be + noise(rng);
+    }
+    auto graph = std::make_shared<Graph>(std::make_shared<Dataset>(std::vector<Column>{ a, b, c, d, e }));
+
+    CausalDiscovery fci;
+    fci.runFCI(graph, 0.05);
+
+    EXPECT_FALSE(graph->hasDirectedEdge(2, 4) || graph->hasDirectedEdge(4, 2));
+    ASSERT_TRUE(fci.getSepsets().hasSepset(2, 4));
+    EXPECT_TRUE(fci.getSepsets().contains(2, 4, 0));
+    EXPECT_TRUE(graph->hasDirectedEdge(1, 2) || graph->hasDirectedEdge(2, 1));
+    EXPECT_TRUE(graph->hasDirectedEdge(3, 4) || graph->hasDirectedEdge(4, 3));
+}
@@ -0,0 +1,97 @@
+#include "ciTestCache.h"
+#include "causalDiscovery.h"
+#include "graph.h"
+#include "dataset.h"
+#include "threadPool.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+TEST(CITestCacheTest, KeyIgnoresPairOrder) {
+    CITestCache cache;
+    cache.store(3, 1, std::vector<int>{ 2, 4 }, 0.25);
+
+    double p_value = 0.0;
+    EXPECT_TRUE(cache.lookup(1, 3, std::vector<int>{ 2, 4 }, p_value));
+    EXPECT_DOUBLE_EQ(p_value, 0.25);
+    EXPECT_TRUE(cache.lookup(3, 1, std::vector<int>{ 2, 4 }, p_value));
+
+    EXPECT_FALSE(cache.lookup(1, 3, std::vector<int>{ 2 }, p_value));
+    EXPECT_FALSE(cache.lookup(1, 2, std::vector<int>{ 4 }, p_value));
+
+    EXPECT_EQ(cache.getHits(), 2);
+    EXPECT_EQ(cache.getMisses(), 2);
+    EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(CITestCacheTest, ClearResetsEntriesAndCounters) {
+    CITestCache cache;
+    double p_value = 0.0;
+    cache.store(0, 1, {}, 0.5);
+    cache.lookup(0, 1, {}, p_value);
+    cache.lookup(0, 2, {}, p_value);
+
+    cache.clear();
+
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.getHits(), 0);
+    EXPECT_EQ(cache.getMisses(), 0);
+    EXPECT_FALSE(cache.lookup(0, 1, {}, p_value));
+}
+
+TEST(CITestCacheTest, DiscoveryRunReusesRepeatedTests) {
+    // Every pair stays dependent given any single variable, so pruning repeats skeleton tests
+    std::mt19937 rng(3);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::vector<Column> columns(4, Column(200));
+    for (size_t r = 0; r < 200; ++r) {
+        double a = noise(rng), b = noise(rng), c = noise(rng), d = noise(rng);
+        columns[0][r] = a + b;
+        columns[1][r] = a + c;
+        columns[2][r] = b + c + d;
+        columns[3][r] = a + b + c + d;
+    }
+    auto graph = std::make_shared<Graph>(std::make_shared<Dataset>(columns));
+
+    CausalDiscovery fci;
+    fci.runFCI(graph, 0.05);
+
+    const CITestCache& cache = fci.getCITestCache();
+    EXPECT_EQ(cache.getMisses(), cache.size());
+    EXPECT_GT(cache.getHits(), 0);
+}
+
+TEST(CITestCacheTest, ConcurrentStoresAndLookupsKeepEveryEntry) {
+    // Each task stores its own triples and reads them back while the others do the same
+    const size_t numTasks = 64;
+    const int triplesPerTask = 50;
+    CITestCache cache;
+    ThreadPool pool(8);
+
+    pool.parallelFor(numTasks, [&](size_t task) {
+        int t = static_cast<int>(task);
+        for (int k = 0; k < triplesPerTask; ++k) {
+            std::vector<int> conditioningSet = { k, 100 + t };
+            cache.store(t, 200 + k, conditioningSet, (t * triplesPerTask + k) / 4096.0);
+        }
+        for (int k = 0; k < triplesPerTask; ++k) {
+            std::vector<int> conditioningSet = { k, 100 + t };
+            double p_value = -1.0;
+            EXPECT_TRUE(cache.lookup(200 + k, t, conditioningSet, p_value));
+            EXPECT_EQ(p_value, (t * triplesPerTask + k) / 4096.0);
+            EXPECT_FALSE(cache.lookup(t, 200 + k, std::vector<int>{ k }, p_value));
+        }
+    });
+
+    EXPECT_EQ(cache.size(), numTasks * triplesPerTask);
+    EXPECT_EQ(cache.getHits(), numTasks * triplesPerTask);
+    EXPECT_EQ(cache.getMisses(), numTasks * triplesPerTask);
+    for (int t = 0; t < static_cast<int>(numTasks); ++t) {
+        for (int k = 0; k < triplesPerTask; ++k) {
+            double p_value = -1.0;
+            ASSERT_TRUE(cache.lookup(t, 200 + k, std::vector<int>{ k, 100 + t }, p_value));
+            EXPECT_EQ(p_value, (t * triplesPerTask + k) / 4096.0);
+        }
+    }
+}
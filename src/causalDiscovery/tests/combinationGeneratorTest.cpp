@@ -0,0 +1,78 @@
+#include "combinationGenerator.h"
+#include "causalDiscovery.h"
+#include "graph.h"
+#include "dataset.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+TEST(CombinationGeneratorTest, EnumeratesSubsetsInLexicographicOrder) {
+    vector<int> candidates = { 2, 5, 7, 9 };
+    CombinationGenerator subsets;
+    subsets.reset(candidates, 2);
+
+    vector<vector<int>> produced;
+    while (subsets.next()) {
+        produced.emplace_back(subsets.current().begin(), subsets.current().end());
+    }
+
+    vector<vector<int>> expected = { { 2, 5 }, { 2, 7 }, { 2, 9 }, { 5, 7 }, { 5, 9 }, { 7, 9 } };
+    EXPECT_EQ(produced, expected);
+}
+
+TEST(CombinationGeneratorTest, HandlesEmptyAndOversizedSubsets) {
+    vector<int> candidates = { 1, 2, 3 };
+    CombinationGenerator subsets;
+
+    subsets.reset(candidates, 0);
+    ASSERT_TRUE(subsets.next());
+    EXPECT_TRUE(subsets.current().empty());
+    EXPECT_FALSE(subsets.next());
+
+    subsets.reset(candidates, 4);
+    EXPECT_FALSE(subsets.next());
+
+    subsets.reset(candidates, 3);
+    ASSERT_TRUE(subsets.next());
+    EXPECT_EQ(vector<int>(subsets.current().begin(), subsets.current().end()), candidates);
+    EXPECT_FALSE(subsets.next());
+}
+
+TEST(CombinationGeneratorTest, SkeletonOnlyConditionsOnAdjacentVertices) {
+    // X -> Z -> Y plus five independent noise columns; only Z can separate X and Y
+    mt19937 rng(5);
+    normal_distribution<double> noise(0.0, 1.0);
+
+    const size_t numRows = 1000;
+    vector<Column> columns(8, Column(numRows));
+    for (size_t r = 0; r < numRows; ++r) {
+        for (auto& column : columns) {
+            column[r] = noise(rng);
+        }
+        columns[1][r] += 0.8 * columns[0][r];
+        columns[2][r] += 0.8 * columns[1][r];
+    }
+
+    auto graph = make_shared<Graph>(make_shared<Dataset>(columns));
+    CausalDiscovery fci;
+    fci.setNumThreads(1);
+    fci.runFCI(graph, 0.01);
+
+    auto sepset = fci.getSepsets().getSepset(0, 2);
+    ASSERT_TRUE(fci.getSepsets().hasSepset(0, 2));
+    EXPECT_EQ(vector<int>(sepset.begin(), sepset.end()), vector<int>{ 1 });
+
+    // With every noise column split off at depth 0, no test ever conditions on more than one vertex
+    EXPECT_LT(fci.getCITestCache().size(), 40u);
+}
+
+TEST(CombinationGeneratorTest, RejectsInvalidDepthCap) {
+    CausalDiscovery fci;
+    EXPECT_THROW(fci.setMaxConditioningDepth(-2), invalid_argument);
+    EXPECT_NO_THROW(fci.setMaxConditioningDepth(-1));
+    EXPECT_NO_THROW(fci.setMaxConditioningDepth(0));
+}
@@ -0,0 +1,150 @@
+#include "correlationMatrix.h"
+#include "statistic.h"
+#include "dataset.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+class CorrelationMatrixTest : public ::testing::Test {
+protected:
+    // X -> Z -> Y chain plus an independent W
+    shared_ptr<Dataset> createChainDataset(size_t num_rows) {
+        mt19937 rng(42);
+        normal_distribution<double> noise(0.0, 1.0);
+
+        Column x(num_rows), z(num_rows), y(num_rows), w(num_rows);
+        for (size_t r = 0; r < num_rows; ++r) {
+            x[r] = noise(rng);
+            z[r] = 0.8 * x[r] + noise(rng);
+            y[r] = 0.7 * z[r] + noise(rng) + 10.0;
+            w[r] = noise(rng);
+        }
+        return make_shared<Dataset>(vector<Column>{ x, z, y, w });
+    }
+};
+
+TEST_F(CorrelationMatrixTest, PartialCorrelationMatchesRecursiveFormula) {
+    auto data = createChainDataset(500);
+    CorrelationMatrix correlations(*data);
+
+    double r_xy = correlations.getCorrelation(0, 2);
+    double r_xz = correlations.getCorrelation(0, 1);
+    double r_yz = correlations.getCorrelation(2, 1);
+    double expected = (r_xy - r_xz * r_yz) / sqrt((1 - r_xz * r_xz) * (1 - r_yz * r_yz));
+
+    EXPECT_NEAR(correlations.partialCorrelation(0, 2, vector<int>{ 1 }), expected, 1e-12);
+    EXPECT_NEAR(correlations.partialCorrelation(0, 2, {}), r_xy, 1e-15);
+}
+
+TEST_F(CorrelationMatrixTest, UnconditionalTestMatchesRegressionPath) {
+    auto data = createChainDataset(500);
+    CorrelationMatrix correlations(*data);
+
+    for (auto statistic : { CITestStatistic::TStatistic, CITestStatistic::FisherZ }) {
+        double p_regression = Statistic::testConditionalIndependence(data, 0, 1, {}, statistic);
+        double p_covariance = Statistic::testConditionalIndependence(correlations, 0, 1, {}, statistic);
+        EXPECT_NEAR(p_regression, p_covariance, 1e-9);
+    }
+}
+
+TEST_F(CorrelationMatrixTest, ConditionalTestIsTheRegressionTestOnCenteredColumns) {
+    // Every column has a non-zero mean, and z depends on x only through its mean-free part
+    mt19937 rng(1);
+    normal_distribution<double> noise(0.0, 1.0);
+    size_t num_rows = 500;
+    vector<Column> columns(4, Column(num_rows));
+    for (size_t r = 0; r < num_rows; ++r) {
+        columns[0][r] = 5.0 + noise(rng);
+        columns[1][r] = 20.0 + 0.8 * (columns[0][r] - 5.0) + noise(rng);
+        columns[2][r] = 10.0 + 0.7 * (columns[1][r] - 20.0) + noise(rng);
+        columns[3][r] = -3.0 + 0.3 * columns[0][r] + noise(rng);
+    }
+    auto data = make_shared<Dataset>(columns);
+    CorrelationMatrix correlations(*data);
+
+    vector<Column> centered = columns;
+    for (Column& column : centered) {
+        double mean = 0.0;
+        for (double value : column) {
+            mean += value / static_cast<double>(num_rows);
+        }
+        for (double& value : column) {
+            value -= mean;
+        }
+    }
+    auto centeredData = make_shared<Dataset>(centered);
+
+    for (auto statistic : { CITestStatistic::TStatistic, CITestStatistic::FisherZ }) {
+        for (const vector<int>& conditioningSet : { vector<int>{ 1 }, vector<int>{ 1, 3 } }) {
+            double p_covariance = Statistic::testConditionalIndependence(correlations, 0, 2, conditioningSet, statistic);
+            EXPECT_NEAR(p_covariance, Statistic::testConditionalIndependence(centeredData, 0, 2, conditioningSet, statistic), 1e-9);
+            EXPECT_NEAR(p_covariance, Statistic::testConditionalIndependenceInPlace(*centeredData, 0, 2, conditioningSet, statistic), 1e-9);
+        }
+
+        // Without an intercept the regression of x and y on z also fits z's mean, and the
+        // raw test finds a dependence the centered one does not
+        EXPECT_GT(Statistic::testConditionalIndependence(correlations, 0, 2, vector<int>{ 1 }, statistic), 0.05);
+        EXPECT_LT(Statistic::testConditionalIndependence(data, 0, 2, vector<int>{ 1 }, statistic), 0.05);
+    }
+}
+
+TEST_F(CorrelationMatrixTest, DetectsConditionalIndependenceInChain) {
+    auto data = createChainDataset(2000);
+    CorrelationMatrix correlations(*data);
+
+    for (auto statistic : { CITestStatistic::TStatistic, CITestStatistic::FisherZ }) {
+        EXPECT_LT(Statistic::testConditionalIndependence(correlations, 0, 2, {}, statistic), 0.05);
+        EXPECT_GT(Statistic::testConditionalIndependence(correlations, 0, 2, vector<int>{ 1 }, statistic), 0.05);
+        EXPECT_GT(Statistic::testConditionalIndependence(correlations, 0, 3, vector<int>{ 1, 2 }, statistic), 0.05);
+    }
+}
+
+TEST_F(CorrelationMatrixTest, ConstantColumnsFollowRegressionConventions) {
+    auto data = make_shared<Dataset>(vector<Column>{
+        { 1, 2, 3, 4, 5 },
+        { 2, 4, 6, 8, 11 },
+        { 1, 1, 1, 1, 1 } });
+    CorrelationMatrix correlations(*data);
+
+    EXPECT_TRUE(correlations.isConstant(2));
+    EXPECT_DOUBLE_EQ(Statistic::testConditionalIndependence(correlations, 0, 2, {}), 1.0);
+    EXPECT_DOUBLE_EQ(Statistic::testConditionalIndependence(correlations, 0, 1, vector<int>{ 2 }), 1e-10);
+}
+
+TEST_F(CorrelationMatrixTest, SizeSpecializedKernelsMatchThePrecisionMatrix) {
+    mt19937 rng(22);
+    normal_distribution<double> noise(0.0, 1.0);
+    vector<Column> columns(8, Column(300));
+    for (size_t r = 0; r < 300; ++r) {
+        columns[0][r] = noise(rng);
+        for (size_t c = 1; c < 8; ++c) {
+            columns[c][r] = 0.4 * columns[c - 1][r] + 0.3 * columns[0][r] + noise(rng);
+        }
+    }
+    CorrelationMatrix correlations(Dataset{ columns });
+
+    // Every size from the closed form through the fixed-size kernels to the generic fallback
+    for (int depth = 1; depth <= 6; ++depth) {
+        vector<int> variables = { 0, 7 };
+        vector<int> conditioningSet;
+        for (int k = 1; k <= depth; ++k) {
+            variables.push_back(k);
+            conditioningSet.push_back(k);
+        }
+
+        Eigen::MatrixXd sub(variables.size(), variables.size());
+        for (size_t a = 0; a < variables.size(); ++a) {
+            for (size_t b = 0; b < variables.size(); ++b) {
+                sub(a, b) = correlations.getCorrelation(variables[a], variables[b]);
+            }
+        }
+        Eigen::MatrixXd precision = sub.inverse();
+        double expected = -precision(0, 1) / sqrt(precision(0, 0) * precision(1, 1));
+
+        EXPECT_NEAR(correlations.partialCorrelation(0, 7, conditioningSet), expected, 1e-12) << "|S| = " << depth;
+    }
+}
@@ -0,0 +1,122 @@
+#include "CSVReader.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class CSVReaderTest : public ::testing::Test {
+protected:
+    string writeFile(const string& name, const string& content) {
+        string path = (filesystem::temp_directory_path() / name).string();
+        ofstream file(path, ios::binary);
+        file << content;
+        return path;
+    }
+};
+
+TEST_F(CSVReaderTest, MappedReaderKeepsTheRowsOfTheStreamReader) {
+    // Header, CRLF, padding, '+', extra columns, short rows and garbage are all handled like std::stod
+    string path = writeFile("csvReaderTest_small.csv",
+        "a,b,c\n"
+        "1,2,3\r\n"
+        " 4.5, +6,7e2,extra\n"
+        "8,9\n"
+        "10,x,12\n"
+        "\n"
+        "13,14,15abc\n"
+        "16,,18\n"
+        "-1.25,1e-3,19");
+
+    auto expected = CSVReader::readCSVFile(path, 3);
+    auto mapped = CSVReader::readCSVFileMapped(path, 3, 2);
+
+    ASSERT_EQ(expected[0].size(), 4u);
+    EXPECT_EQ(mapped, expected);
+    EXPECT_DOUBLE_EQ(mapped[1][1], 6.0);
+    EXPECT_DOUBLE_EQ(mapped[2][2], 15.0);
+}
+
+TEST_F(CSVReaderTest, ParallelChunksMatchTheStreamReader) {
+    mt19937 rng(1);
+    uniform_real_distribution<double> value(-1000.0, 1000.0);
+
+    string content = "x,y,z,w\n";
+    for (int r = 0; r < 60000; ++r) {
+        if (r % 997 == 0) {
+            content += "broken,row\n";
+            continue;
+        }
+        content += to_string(value(rng)) + "," + to_string(value(rng)) + "," + to_string(value(rng)) + "," + to_string(r) + "\n";
+    }
+    string path = writeFile("csvReaderTest_large.csv", content);
+
+    auto expected = CSVReader::readCSVFile(path, 4);
+    for (size_t threads : { 1, 3, 8 }) {
+        EXPECT_EQ(CSVReader::readCSVFileMapped(path, 4, threads), expected);
+    }
+}
+
+TEST_F(CSVReaderTest, MappedReaderHandlesEmptyAndMissingFiles) {
+    string path = writeFile("csvReaderTest_empty.csv", "");
+    auto columns = CSVReader::readCSVFileMapped(path, 2);
+    ASSERT_EQ(columns.size(), 2u);
+    EXPECT_TRUE(columns[0].empty());
+
+    EXPECT_THROW(CSVReader::readCSVFileMapped("does_not_exist.csv", 2), runtime_error);
+}
+
+TEST_F(CSVReaderTest, ProjectsColumnsByHeaderName) {
+    string path = writeFile("csvReaderTest_header.csv",
+        "\xEF\xBB\xBFid, \"Power\" ,Name,CO2,Noise\r\n"
+        "1,110,alpha,140,70\r\n"
+        "2,95,beta,n/a,71\r\n"
+        "3,130,gamma delta,150,72\r\n"
+        "4,80,,120,69\r\n");
+
+    auto columns = CSVReader::readCSVColumns(path, { "CO2", "Power" }, 2);
+
+    // Row 2 has no CO2 value; the text in Name is never parsed, so row 4 survives
+    ASSERT_EQ(columns.size(), 2u);
+    EXPECT_EQ(columns[0], (Column{ 140, 150, 120 }));
+    EXPECT_EQ(columns[1], (Column{ 110, 130, 80 }));
+}
+
+TEST_F(CSVReaderTest, KeepsRowsWithMissingFieldsAsNaN) {
+    string path = writeFile("csvReaderTest_missing.csv",
+        "id,Power,CO2\n"
+        "1,110,140\n"
+        "2,95,n/a\n"
+        "3,,150\n"
+        "4,80\n"
+        "5,x,y\n"
+        "\n"
+        "6,120,130");
+
+    auto columns = CSVReader::readCSVColumns(path, { "CO2", "Power" }, 2, MissingFields::KeepAsNaN);
+
+    // Rows with at least one selected number survive; blank and all-text rows do not
+    ASSERT_EQ(columns[0].size(), 5u);
+    EXPECT_EQ(columns[0][0], 140);
+    EXPECT_TRUE(isnan(columns[0][1]));
+    EXPECT_EQ(columns[0][2], 150);
+    EXPECT_TRUE(isnan(columns[0][3]));
+    EXPECT_EQ(columns[0][4], 130);
+    EXPECT_TRUE(isnan(columns[1][2]));
+    EXPECT_EQ(columns[1][3], 80);
+
+    EXPECT_EQ(CSVReader::readCSVColumns(path, { "CO2", "Power" })[0], (Column{ 140, 130 }));
+}
+
+TEST_F(CSVReaderTest, RejectsUnknownOrRepeatedColumnNames) {
+    string path = writeFile("csvReaderTest_names.csv", "a,b\n1,2\n");
+
+    EXPECT_THROW(CSVReader::readCSVColumns(path, { "a", "c" }), invalid_argument);
+    EXPECT_THROW(CSVReader::readCSVColumns(path, { "b", "b" }), invalid_argument);
+    EXPECT_EQ(CSVReader::readCSVColumns(path, { "b" })[0], (Column{ 2 }));
+}
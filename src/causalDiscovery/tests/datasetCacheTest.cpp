@@ -0,0 +1,100 @@
+#include "datasetCache.h"
+#include "statistic.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class DatasetCacheTest : public ::testing::Test {
+protected:
+    string tempPath(const string& name) {
+        return (filesystem::temp_directory_path() / name).string();
+    }
+
+    vector<Column> createColumns(size_t numColumns, size_t numRows) {
+        mt19937 rng(5);
+        normal_distribution<double> noise(0.0, 1.0);
+
+        vector<Column> columns(numColumns, Column(numRows));
+        for (size_t r = 0; r < numRows; ++r) {
+            for (size_t c = 0; c < numColumns; ++c) {
+                columns[c][r] = noise(rng) + (c > 0 ? 0.7 * columns[c - 1][r] : 0.0);
+            }
+        }
+        return columns;
+    }
+};
+
+TEST_F(DatasetCacheTest, ReloadedDatasetReadsTheSavedValuesInPlace) {
+    auto columns = createColumns(3, 37);
+    columns[2][4] = numeric_limits<double>::quiet_NaN();
+    Dataset original(columns);
+
+    string path = tempPath("datasetCacheTest_roundtrip.bin");
+    DatasetCache::save(path, original, { "speed", "", "temperature" });
+    EXPECT_TRUE(DatasetCache::isCacheFile(path));
+
+    vector<string> names;
+    auto reloaded = DatasetCache::load(path, names);
+
+    EXPECT_EQ(names, (vector<string>{ "speed", "", "temperature" }));
+    EXPECT_EQ(reloaded->getStorage(), DatasetStorage::Mapped);
+    ASSERT_EQ(reloaded->getNumOfColumns(), 3u);
+
+    for (int c = 0; c < 3; ++c) {
+        auto view = reloaded->getColumnView(c);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(view.data()) % Dataset::Alignment, 0u);
+        ASSERT_EQ(view.size(), 37u);
+        for (size_t r = 0; r < view.size(); ++r) {
+            EXPECT_TRUE(view[r] == columns[c][r] || (isnan(view[r]) && isnan(columns[c][r])));
+        }
+
+        const ColumnProfile& saved = original.getColumnProfile(c);
+        const ColumnProfile& loaded = reloaded->getColumnProfile(c);
+        EXPECT_EQ(loaded.hash, saved.hash);
+        EXPECT_EQ(loaded.nanCount, saved.nanCount);
+        EXPECT_EQ(loaded.constant, saved.constant);
+        EXPECT_TRUE(loaded.mean == saved.mean || (isnan(loaded.mean) && isnan(saved.mean)));
+    }
+
+    EXPECT_EQ(reloaded->getMatrix().rows(), 37);
+    EXPECT_THROW(reloaded->addColumn(Column(37)), runtime_error);
+
+    // CI tests give the same answers on the mapped copy
+    auto source = make_shared<Dataset>(columns);
+    EXPECT_DOUBLE_EQ(Statistic::testConditionalIndependence(reloaded, 0, 1, {}), Statistic::testConditionalIndependence(source, 0, 1, {}));
+    EXPECT_DOUBLE_EQ(Statistic::testConditionalIndependence(reloaded, 0, 2, vector<int>{ 1 }), Statistic::testConditionalIndependence(source, 0, 2, vector<int>{ 1 }));
+}
+
+TEST_F(DatasetCacheTest, RejectsFilesThatAreNotCaches) {
+    string csvPath = tempPath("datasetCacheTest_not_a_cache.csv");
+    ofstream(csvPath) << "a,b\n1,2\n";
+    EXPECT_FALSE(DatasetCache::isCacheFile(csvPath));
+    EXPECT_THROW(DatasetCache::load(csvPath), runtime_error);
+
+    // Cut the payload short
+    string path = tempPath("datasetCacheTest_truncated.bin");
+    DatasetCache::save(path, Dataset(createColumns(2, 100)));
+    filesystem::resize_file(path, filesystem::file_size(path) - 64);
+    EXPECT_THROW(DatasetCache::load(path), runtime_error);
+
+    // A newer version is refused rather than misread
+    DatasetCache::save(path, Dataset(createColumns(2, 10)));
+    {
+        fstream file(path, ios::in | ios::out | ios::binary);
+        file.seekp(8);
+        uint32_t version = DatasetCache::Version + 1;
+        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    }
+    EXPECT_THROW(DatasetCache::load(path), runtime_error);
+
+    EXPECT_THROW(DatasetCache::save(path, Dataset(createColumns(2, 10)), { "only one name" }), invalid_argument);
+}
@@ -0,0 +1,140 @@
+#include "dataset.h"
+#include "correlationMatrix.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+class DatasetTest : public ::testing::Test {
+protected:
+    vector<Column> createColumns(size_t numColumns, size_t numRows) {
+        mt19937 rng(17);
+        normal_distribution<double> noise(0.0, 1.0);
+
+        vector<Column> columns(numColumns, Column(numRows));
+        for (size_t r = 0; r < numRows; ++r) {
+            for (size_t c = 0; c < numColumns; ++c) {
+                columns[c][r] = noise(rng) + (c > 0 ? 0.5 * columns[c - 1][r] : 0.0);
+            }
+        }
+        return columns;
+    }
+};
+
+TEST_F(DatasetTest, ContiguousColumnsAreAlignedAndMatchTheInput) {
+    auto columns = createColumns(5, 13);
+    Dataset data(columns, DatasetStorage::Contiguous);
+
+    ASSERT_EQ(data.getNumOfColumns(), 5u);
+    EXPECT_EQ(data.getColumnStride(), 16u);
+
+    for (int c = 0; c < 5; ++c) {
+        auto view = data.getColumnView(c);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(view.data()) % Dataset::Alignment, 0u);
+        EXPECT_EQ(Column(view.begin(), view.end()), columns[c]);
+        EXPECT_EQ(*data.getColumn(c), columns[c]);
+    }
+
+    auto matrix = data.getMatrix();
+    EXPECT_EQ(matrix.rows(), 13);
+    EXPECT_EQ(matrix.cols(), 5);
+    EXPECT_DOUBLE_EQ(matrix(12, 4), columns[4][12]);
+
+    EXPECT_EQ(data.getColumn(5), nullptr);
+    EXPECT_THROW(data.getColumnView(5), out_of_range);
+}
+
+TEST_F(DatasetTest, ContiguousStorageRequiresEqualColumnLengths) {
+    Dataset data({ { 1, 2, 3 } }, DatasetStorage::Contiguous);
+    EXPECT_THROW(data.addColumn(Column{ 1, 2 }), invalid_argument);
+
+    data.addColumn(Column{ 4, 5, 6 });
+    EXPECT_EQ(data.getNumOfColumns(), 2u);
+    EXPECT_DOUBLE_EQ(data.getMatrix()(2, 1), 6.0);
+
+    Dataset columnwise({ { 1, 2, 3 } });
+    EXPECT_THROW(columnwise.getMatrix(), runtime_error);
+}
+
+TEST_F(DatasetTest, StorageModesGiveTheSameCorrelations) {
+    auto columns = createColumns(4, 200);
+    CorrelationMatrix fromColumns(Dataset(columns, DatasetStorage::Columns));
+    CorrelationMatrix fromContiguous(Dataset(columns, DatasetStorage::Contiguous));
+
+    for (int a = 0; a < 4; ++a) {
+        for (int b = 0; b < 4; ++b) {
+            EXPECT_DOUBLE_EQ(fromColumns.getCorrelation(a, b), fromContiguous.getCorrelation(a, b));
+        }
+    }
+}
+
+TEST_F(DatasetTest, ProfilesAreComputedWhenColumnsAreAdded) {
+    double nan = numeric_limits<double>::quiet_NaN();
+    for (auto storage : { DatasetStorage::Columns, DatasetStorage::Contiguous }) {
+        Dataset data({ { 1, 2, 3, 6 }, { 5, 5, 5, 5 }, { 1, nan, -4, 2 }, { 1, 2, 3, 6 }, { 0.0, 0.0, 1, 1 } }, storage);
+
+        const ColumnProfile& profile = data.getColumnProfile(0);
+        EXPECT_EQ(profile.numRows, 4u);
+        EXPECT_DOUBLE_EQ(profile.mean, 3.0);
+        EXPECT_DOUBLE_EQ(profile.variance, 14.0 / 3.0);
+        EXPECT_DOUBLE_EQ(profile.min, 1.0);
+        EXPECT_DOUBLE_EQ(profile.max, 6.0);
+        EXPECT_FALSE(profile.constant);
+        EXPECT_EQ(profile.nanCount, 0u);
+
+        EXPECT_TRUE(data.getColumnProfile(1).constant);
+        EXPECT_DOUBLE_EQ(data.getColumnProfile(1).variance, 0.0);
+
+        EXPECT_EQ(data.getColumnProfile(2).nanCount, 1u);
+        EXPECT_FALSE(data.getColumnProfile(2).constant);
+        EXPECT_DOUBLE_EQ(data.getColumnProfile(2).min, -4.0);
+        EXPECT_TRUE(isnan(data.getColumnProfile(2).mean));
+
+        EXPECT_TRUE(data.areDuplicateColumns(0, 3));
+        EXPECT_FALSE(data.areDuplicateColumns(0, 4));
+        EXPECT_FALSE(data.areDuplicateColumns(2, 2)); // NaN never equals itself
+        EXPECT_THROW(data.getColumnProfile(5), out_of_range);
+    }
+
+    Dataset signedZeros({ { 0.0, 1.0 }, { -0.0, 1.0 } });
+    EXPECT_TRUE(signedZeros.areDuplicateColumns(0, 1));
+}
+
+TEST_F(DatasetTest, ValidityBitmapsMarkMissingValues) {
+    double nan = numeric_limits<double>::quiet_NaN();
+    auto columns = createColumns(3, 130);
+    columns[1][0] = nan;
+    columns[1][64] = nan;
+    columns[1][129] = nan;
+    columns[2][64] = nan;
+
+    for (auto storage : { DatasetStorage::Columns, DatasetStorage::Contiguous }) {
+        Dataset data(columns, storage);
+
+        // Complete columns carry no bitmap
+        EXPECT_EQ(data.getValidity(0), nullptr);
+
+        const ValidityBitmap* validity = data.getValidity(1);
+        ASSERT_NE(validity, nullptr);
+        EXPECT_EQ(validity->getNumRows(), 130u);
+        EXPECT_EQ(validity->getWords().size(), 3u);
+        EXPECT_EQ(validity->countValid(), 127u);
+        EXPECT_FALSE(validity->isValid(64));
+        EXPECT_TRUE(validity->isValid(65));
+
+        // Bits past the last row stay clear, so ANDed bitmaps can be counted directly
+        EXPECT_EQ(validity->getWords()[2], ValidityBitmap::fullWord(130, 2) & ~(ValidityBitmap::Word(1) << 1));
+
+        ValidityBitmap both = *validity;
+        both.andWith(*data.getValidity(2));
+        EXPECT_EQ(both.countValid(), 127u);
+
+        EXPECT_THROW(data.getValidity(3), out_of_range);
+    }
+}
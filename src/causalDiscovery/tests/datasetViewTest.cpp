@@ -0,0 +1,178 @@
+#include "datasetView.h"
+#include "causalDiscovery.h"
+#include "correlationMatrix.h"
+#include "graph.h"
+#include "rowDeduplicator.h"
+#include "statistic.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+class DatasetViewTest : public ::testing::Test {
+protected:
+    // Chain 0 -> 1 -> 2 -> 3 with 0 also driving 3
+    vector<Column> createChain(size_t numRows) {
+        mt19937 rng(20);
+        normal_distribution<double> noise(0.0, 1.0);
+        vector<Column> columns(4, Column(numRows));
+        for (size_t r = 0; r < numRows; ++r) {
+            columns[0][r] = noise(rng);
+            columns[1][r] = 0.8 * columns[0][r] + noise(rng);
+            columns[2][r] = 0.6 * columns[1][r] + noise(rng);
+            columns[3][r] = 0.5 * columns[2][r] + 0.4 * columns[0][r] + noise(rng);
+        }
+        return columns;
+    }
+
+    // The rows a view stands for, copied out as an ordinary dataset
+    static vector<Column> materialise(const vector<Column>& columns, const vector<size_t>& rows) {
+        vector<Column> copy(columns.size());
+        for (size_t c = 0; c < columns.size(); ++c) {
+            for (size_t row : rows) {
+                copy[c].push_back(columns[c][row]);
+            }
+        }
+        return copy;
+    }
+
+    static void expectSamePValues(const shared_ptr<const Dataset>& view, const shared_ptr<const Dataset>& copy) {
+        CorrelationMatrix viewCorrelations(*view);
+        CorrelationMatrix copyCorrelations(*copy);
+        EXPECT_EQ(viewCorrelations.getNumRows(), copyCorrelations.getNumRows());
+
+        for (auto statistic : { CITestStatistic::TStatistic, CITestStatistic::FisherZ }) {
+            for (const vector<int>& conditioningSet : vector<vector<int>>{ {}, { 1 }, { 1, 2 } }) {
+                double expected = Statistic::testConditionalIndependence(copy, 0, 3, conditioningSet, statistic);
+                EXPECT_NEAR(Statistic::testConditionalIndependence(view, 0, 3, conditioningSet, statistic), expected, 1e-9);
+                EXPECT_NEAR(Statistic::testConditionalIndependenceInPlace(*view, 0, 3, conditioningSet, statistic), expected, 1e-9);
+                EXPECT_NEAR(Statistic::testConditionalIndependenceTestWise(*view, 0, 3, conditioningSet, statistic), expected, 1e-9);
+                EXPECT_NEAR(Statistic::testConditionalIndependence(viewCorrelations, 0, 3, conditioningSet, statistic),
+                    Statistic::testConditionalIndependence(copyCorrelations, 0, 3, conditioningSet, statistic), 1e-9);
+            }
+        }
+    }
+};
+
+TEST_F(DatasetViewTest, SubsampleMatchesACopyAndSharesTheColumns) {
+    auto columns = createChain(700);
+    // Rows outside every view are missing, which a view must never read
+    columns[2][1] = numeric_limits<double>::quiet_NaN();
+
+    for (auto storage : { DatasetStorage::Columns, DatasetStorage::Contiguous }) {
+        auto parent = make_shared<Dataset>(columns, storage);
+
+        vector<size_t> rows;
+        for (size_t r = 3; r < 700; r += 3) {
+            rows.push_back(r);
+        }
+        auto view = make_shared<DatasetView>(parent, rows);
+        auto copy = make_shared<Dataset>(materialise(columns, rows));
+
+        EXPECT_EQ(view->getParent(), parent);
+        EXPECT_EQ(view->getNumSelectedRows(), rows.size());
+        EXPECT_EQ(view->getSampleSize(), rows.size());
+        EXPECT_TRUE(view->getRowWeights().empty());
+        EXPECT_EQ(view->getRowCounts(), nullptr);
+        EXPECT_EQ(view->getStoredColumnView(1).data(), parent->getColumnView(1).data());
+
+        // A view has no column of its own rows to hand out
+        EXPECT_THROW(view->getColumnView(1), runtime_error);
+        EXPECT_THROW(view->getColumn(1), runtime_error);
+        EXPECT_THROW(view->getMatrix(), runtime_error);
+        for (int c = 0; c < 4; ++c) {
+            EXPECT_NEAR(view->getColumnProfile(c).mean, copy->getColumnProfile(c).mean, 1e-12);
+            EXPECT_NEAR(view->getColumnProfile(c).variance, copy->getColumnProfile(c).variance, 1e-12);
+            EXPECT_EQ(view->getColumnProfile(c).nanCount, 0u);
+        }
+        expectSamePValues(view, copy);
+
+        // The same subsample given as a bitmap
+        ValidityBitmap selection = ValidityBitmap::allClear(700);
+        for (size_t row : rows) {
+            selection.setValid(row);
+        }
+        expectSamePValues(make_shared<DatasetView>(parent, selection), copy);
+    }
+}
+
+TEST_F(DatasetViewTest, BootstrapSampleWeighsRepeatedRows) {
+    auto columns = createChain(500);
+    mt19937 rng(7);
+    uniform_int_distribution<size_t> pick(0, 499);
+    vector<size_t> rows(500);
+    for (auto& row : rows) {
+        row = pick(rng);
+    }
+
+    auto parent = make_shared<Dataset>(columns);
+    auto view = make_shared<DatasetView>(parent, rows);
+    EXPECT_EQ(view->getSampleSize(), 500u);
+    EXPECT_LT(view->getNumSelectedRows(), 500u);
+    ASSERT_NE(view->getRowCounts(), nullptr);
+    EXPECT_EQ(view->getRowCounts()->get(rows[0]), static_cast<size_t>(ranges::count(rows, rows[0])));
+    expectSamePValues(view, make_shared<Dataset>(materialise(columns, rows)));
+
+    // Every row once and every seventh row again: the full 64-row blocks form their weights from the counts
+    vector<size_t> covering(500);
+    for (size_t r = 0; r < 500; ++r) {
+        covering[r] = r;
+    }
+    for (size_t r = 0; r < 500; r += 7) {
+        covering.push_back(r);
+    }
+    expectSamePValues(make_shared<DatasetView>(parent, covering), make_shared<Dataset>(materialise(columns, covering)));
+
+    // Over a weighted parent a picked row carries its parent weight
+    auto unique = RowDeduplicator::deduplicate(Dataset(materialise(columns, rows)));
+    EXPECT_EQ(unique->getSampleSize(), 500u);
+    vector<size_t> twice = { 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    vector<size_t> expanded;
+    auto weights = unique->getRowWeights();
+    vector<Column> uniqueColumns(4);
+    for (int c = 0; c < 4; ++c) {
+        auto values = unique->getColumnView(c);
+        uniqueColumns[c].assign(values.begin(), values.end());
+    }
+    for (size_t row : twice) {
+        for (int w = 0; w < static_cast<int>(weights[row]); ++w) {
+            expanded.push_back(row);
+        }
+    }
+    auto weightedView = make_shared<DatasetView>(unique, twice);
+    EXPECT_EQ(weightedView->getSampleSize(), expanded.size());
+    auto copy = make_shared<Dataset>(materialise(uniqueColumns, expanded));
+    EXPECT_NEAR(Statistic::testConditionalIndependence(weightedView, 0, 3, vector<int>{ 1 }),
+        Statistic::testConditionalIndependence(copy, 0, 3, vector<int>{ 1 }), 1e-9);
+}
+
+TEST_F(DatasetViewTest, DiscoveryRunsOnAView) {
+    auto columns = createChain(2000);
+    auto parent = make_shared<Dataset>(columns);
+    vector<size_t> rows;
+    for (size_t r = 0; r < 2000; r += 2) {
+        rows.push_back(r);
+    }
+
+    auto viewGraph = make_shared<Graph>(make_shared<DatasetView>(parent, rows));
+    auto copyGraph = make_shared<Graph>(make_shared<Dataset>(materialise(columns, rows)));
+    CausalDiscovery().runFCI(viewGraph, 0.05);
+    CausalDiscovery().runFCI(copyGraph, 0.05);
+    EXPECT_EQ(viewGraph->getEdges(), copyGraph->getEdges());
+}
+
+TEST_F(DatasetViewTest, RejectsInvalidSelections) {
+    auto parent = make_shared<Dataset>(createChain(10));
+    EXPECT_THROW(DatasetView(parent, vector<size_t>{ 0, 10 }), invalid_argument);
+    EXPECT_THROW(DatasetView(parent, ValidityBitmap::allClear(9)), invalid_argument);
+
+    auto view = make_shared<DatasetView>(parent, vector<size_t>{ 1, 2, 3 });
+    EXPECT_THROW(DatasetView(view, vector<size_t>{ 1 }), invalid_argument);
+    EXPECT_THROW(view->addColumn(Column(10, 0.0)), runtime_error);
+}
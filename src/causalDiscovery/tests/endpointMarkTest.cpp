@@ -0,0 +1,78 @@
+#include "endpointMarkMatrix.h"
+#include "graph.h"
+#include "dataset.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+TEST(EndpointMarkTest, PackedMarksDoNotOverlap) {
+    EndpointMarkMatrix marks(40);
+    marks.set(2, 31, EndpointMark::Circle);
+    marks.set(2, 32, EndpointMark::Arrow);
+    marks.set(2, 30, EndpointMark::Tail);
+    marks.set(2, 31, EndpointMark::Arrow);
+
+    EXPECT_EQ(marks.get(2, 30), EndpointMark::Tail);
+    EXPECT_EQ(marks.get(2, 31), EndpointMark::Arrow);
+    EXPECT_EQ(marks.get(2, 32), EndpointMark::Arrow);
+    EXPECT_EQ(marks.get(2, 33), EndpointMark::None);
+    EXPECT_EQ(marks.get(3, 31), EndpointMark::None);
+}
+
+TEST(EndpointMarkTest, DirectedEdgesMapToMarks) {
+    auto graph = make_shared<Graph>(make_shared<Dataset>(vector<Column>(3)));
+    graph->addDoubleDirectedEdge(0, 1);
+    graph->addDirectedEdge(1, 2);
+
+    EXPECT_EQ(graph->getEndpointMark(0, 1), EndpointMark::Circle);
+    EXPECT_EQ(graph->getEndpointMark(1, 0), EndpointMark::Circle);
+    EXPECT_EQ(graph->getEndpointMark(1, 2), EndpointMark::Arrow);
+    EXPECT_EQ(graph->getEndpointMark(2, 1), EndpointMark::Tail);
+    EXPECT_EQ(graph->getEndpointMark(0, 2), EndpointMark::None);
+
+    graph->removeSingleEdge(1, 0);
+    EXPECT_EQ(graph->getEndpointMark(0, 1), EndpointMark::Arrow);
+    EXPECT_EQ(graph->getEndpointMark(1, 0), EndpointMark::Tail);
+}
+
+TEST(EndpointMarkTest, MarksUpdateDirectedEdgesInPlace) {
+    auto graph = make_shared<Graph>(make_shared<Dataset>(vector<Column>(3)));
+    graph->addDoubleDirectedEdge(0, 1);
+
+    // 0 o-> 1 keeps 0 -> 1 and drops 1 -> 0
+    graph->setEndpointMark(0, 1, EndpointMark::Arrow);
+    EXPECT_EQ(graph->getEndpointMark(1, 0), EndpointMark::Circle);
+    EXPECT_TRUE(graph->hasDirectedEdge(0, 1));
+    EXPECT_FALSE(graph->hasDirectedEdge(1, 0));
+
+    // 0 <-> 1 stays adjacent in both directions
+    graph->setEndpointMark(1, 0, EndpointMark::Arrow);
+    EXPECT_TRUE(graph->hasDoubleDirectedEdge(0, 1));
+
+    graph->setEdge(2, 1, EndpointMark::Tail, EndpointMark::Arrow);
+    EXPECT_TRUE(graph->hasDirectedEdge(2, 1));
+    EXPECT_FALSE(graph->hasDirectedEdge(1, 2));
+
+    graph->setEndpointMark(0, 1, EndpointMark::None);
+    EXPECT_EQ(graph->getEndpointMark(1, 0), EndpointMark::None);
+    EXPECT_FALSE(graph->hasDirectedEdge(0, 1));
+    EXPECT_FALSE(graph->hasDirectedEdge(1, 0));
+
+    // Marks can only change on existing edges
+    graph->setEndpointMark(0, 2, EndpointMark::Arrow);
+    EXPECT_EQ(graph->getEndpointMark(0, 2), EndpointMark::None);
+}
+
+TEST(EndpointMarkTest, EdgesReportOrientationFromMarks) {
+    auto graph = make_shared<Graph>(make_shared<Dataset>(vector<Column>(4)));
+    graph->addDoubleDirectedEdge(0, 1);
+    graph->setEdge(1, 2, EndpointMark::Arrow, EndpointMark::Arrow);
+    graph->setEdge(3, 2, EndpointMark::Circle, EndpointMark::Arrow);
+
+    // o-o is the only unoriented edge; 1 <-> 2 is adjacent both ways but oriented
+    vector<tuple<int, int, bool>> expected = { { 0, 1, false }, { 1, 2, true }, { 3, 2, true } };
+    EXPECT_EQ(graph->getEdges(), expected);
+}
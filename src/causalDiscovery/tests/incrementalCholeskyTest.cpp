@@ -0,0 +1,160 @@
+#include "incrementalCholesky.h"
+#include "causalDiscovery.h"
+#include "correlationMatrix.h"
+#include "graph.h"
+#include "statistic.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+vector<Column> createData(size_t numRows) {
+    mt19937 rng(23);
+    normal_distribution<double> noise(0.0, 1.0);
+    vector<Column> columns(7, Column(numRows));
+    for (size_t r = 0; r < numRows; ++r) {
+        columns[0][r] = noise(rng);
+        for (size_t c = 1; c < 7; ++c) {
+            columns[c][r] = 0.5 * columns[c - 1][r] + 0.2 * columns[0][r] + noise(rng);
+        }
+    }
+    return columns;
+}
+
+} // namespace
+
+TEST(IncrementalCholeskyTest, AssignKeepsTheSharedPrefix) {
+    Dataset data(createData(100));
+    IncrementalCholesky factor(data);
+
+    factor.assign(vector<int>{ 1, 2, 3 });
+    EXPECT_EQ(factor.getNumPushes(), 3u);
+    factor.assign(vector<int>{ 1, 2, 4 });
+    EXPECT_EQ(factor.getNumPushes(), 4u);
+    factor.assign(vector<int>{ 1, 3 });
+    EXPECT_EQ(factor.getNumPushes(), 5u);
+    EXPECT_EQ(vector<int>(factor.getVariables().begin(), factor.getVariables().end()), (vector<int>{ 1, 3 }));
+
+    factor.pop();
+    factor.pop();
+    EXPECT_THROW(factor.pop(), out_of_range);
+}
+
+TEST(IncrementalCholeskyTest, UpdatedFactorMatchesTestsSolvedFromScratch) {
+    auto data = make_shared<Dataset>(createData(600));
+    CorrelationMatrix correlations(*data);
+    CrossProductMatrix crossProducts(*data);
+    IncrementalCholesky dataFactor(*data);
+    IncrementalCholesky sharedFactor(crossProducts);
+    IncrementalCholesky correlationFactor(correlations);
+    IncrementalCholesky columnFactor = IncrementalCholesky::ofColumns(*data);
+    ResidualCache disabled(0);
+
+    // Lexicographic subsets of {1..5}, as the skeleton search enumerates them
+    for (const vector<int>& conditioningSet : vector<vector<int>>{ { 1 }, { 1, 2 }, { 1, 2, 3 }, { 1, 2, 4 }, { 1, 3, 5 }, { 2, 3, 4, 5 }, { 1, 2, 3, 4, 5 } }) {
+        for (auto statistic : { CITestStatistic::TStatistic, CITestStatistic::FisherZ }) {
+            EXPECT_NEAR(Statistic::testConditionalIndependenceInPlace(*data, 0, 6, conditioningSet, disabled, statistic, &dataFactor),
+                Statistic::testConditionalIndependenceInPlace(*data, 0, 6, conditioningSet, statistic), 1e-9);
+            EXPECT_NEAR(Statistic::testConditionalIndependenceInPlace(*data, 0, 6, conditioningSet, disabled, statistic, &sharedFactor),
+                Statistic::testConditionalIndependenceInPlace(*data, 0, 6, conditioningSet, statistic), 1e-9);
+            EXPECT_NEAR(Statistic::testConditionalIndependence(data, 0, 6, conditioningSet, disabled, statistic, &columnFactor),
+                Statistic::testConditionalIndependence(data, 0, 6, conditioningSet, statistic), 1e-9);
+            EXPECT_NEAR(Statistic::testConditionalIndependence(correlations, 0, 6, conditioningSet, disabled, statistic, &correlationFactor),
+                Statistic::testConditionalIndependence(correlations, 0, 6, conditioningSet, statistic), 1e-9);
+        }
+    }
+    EXPECT_LT(dataFactor.getNumPushes(), 1u + 2u + 3u + 3u + 3u + 4u + 5u);
+    EXPECT_EQ(columnFactor.getNumPushes(), dataFactor.getNumPushes());
+}
+
+TEST(IncrementalCholeskyTest, FactorOfColumnsHonoursRowWeights) {
+    auto columns = createData(300);
+    Column weights(300);
+    for (size_t r = 0; r < 300; ++r) {
+        weights[r] = static_cast<double>(1 + r % 3);
+    }
+    auto data = make_shared<Dataset>(columns, weights);
+    IncrementalCholesky factor = IncrementalCholesky::ofColumns(*data);
+    ResidualCache disabled(0);
+
+    for (const vector<int>& conditioningSet : vector<vector<int>>{ { 2 }, { 2, 3 }, { 2, 3, 5 } }) {
+        EXPECT_NEAR(Statistic::testConditionalIndependence(data, 1, 4, conditioningSet, disabled, CITestStatistic::TStatistic, &factor),
+            Statistic::testConditionalIndependence(data, 1, 4, conditioningSet), 1e-9);
+    }
+
+    // The cross-products are weighted too
+    CrossProductMatrix crossProducts(*data);
+    double expected = 0.0;
+    for (size_t r = 0; r < 300; ++r) {
+        expected += weights[r] * columns[1][r] * columns[4][r];
+    }
+    EXPECT_NEAR(crossProducts.getCrossProduct(1, 4), expected, 1e-9 * abs(expected));
+    EXPECT_EQ(crossProducts.getCrossProduct(4, 1), crossProducts.getCrossProduct(1, 4));
+}
+
+TEST(IncrementalCholeskyTest, CollinearConditioningVariableIsProjectedOut) {
+    auto columns = createData(400);
+    for (size_t r = 0; r < 400; ++r) {
+        columns[4][r] = 2.0 * columns[1][r] - columns[2][r];
+    }
+    auto data = make_shared<Dataset>(columns);
+    IncrementalCholesky factor(*data);
+    IncrementalCholesky columnFactor = IncrementalCholesky::ofColumns(*data);
+    ResidualCache disabled(0);
+
+    // {1, 2, 4} spans the same space as {1, 2}
+    vector<int> conditioningSet = { 1, 2, 4 };
+    EXPECT_NEAR(Statistic::testConditionalIndependenceInPlace(*data, 0, 6, conditioningSet, disabled, CITestStatistic::TStatistic, &factor),
+        Statistic::testConditionalIndependenceInPlace(*data, 0, 6, conditioningSet), 1e-9);
+    EXPECT_NEAR(Statistic::testConditionalIndependence(data, 0, 6, conditioningSet, disabled, CITestStatistic::TStatistic, &columnFactor),
+        Statistic::testConditionalIndependence(data, 0, 6, conditioningSet), 1e-9);
+}
+
+TEST(IncrementalCholeskyTest, DuplicatedAndCollinearColumnsGiveTheSameDecisions) {
+    auto columns = createData(400);
+    for (size_t r = 0; r < 400; ++r) {
+        columns[5][r] = columns[1][r];
+        columns[4][r] = 2.0 * columns[1][r] - columns[2][r];
+    }
+    auto data = make_shared<Dataset>(columns);
+    CorrelationMatrix correlations(*data);
+    IncrementalCholesky factor(*data);
+    IncrementalCholesky correlationFactor(correlations);
+    ResidualCache disabled(0);
+    const double alpha = 0.05;
+
+    // Duplicated and collinear conditioning columns, and tested variables the set fits exactly
+    for (const vector<int>& conditioningSet : vector<vector<int>>{ { 1, 5 }, { 1, 2, 4 }, { 1, 2, 4, 5 }, { 2, 4 }, { 5 } }) {
+        for (auto [i, j] : vector<pair<int, int>>{ { 0, 6 }, { 0, 3 }, { 1, 6 }, { 3, 6 } }) {
+            if (find(conditioningSet.begin(), conditioningSet.end(), i) != conditioningSet.end()) {
+                continue;
+            }
+            EXPECT_EQ(Statistic::testConditionalIndependenceInPlace(*data, i, j, conditioningSet, disabled, CITestStatistic::TStatistic, &factor) > alpha,
+                Statistic::testConditionalIndependenceInPlace(*data, i, j, conditioningSet) > alpha);
+            EXPECT_EQ(Statistic::testConditionalIndependence(correlations, i, j, conditioningSet, disabled, CITestStatistic::TStatistic, &correlationFactor) > alpha,
+                Statistic::testConditionalIndependence(correlations, i, j, conditioningSet) > alpha);
+        }
+    }
+}
+
+TEST(IncrementalCholeskyTest, DiscoveryResultIsUnchanged) {
+    auto columns = createData(1500);
+    for (auto mode : { CITestMode::InPlace, CITestMode::Covariance }) {
+        CausalDiscovery regression;
+        auto expected = make_shared<Graph>(make_shared<Dataset>(columns));
+        regression.runFCI(expected, 0.05);
+
+        CausalDiscovery factored;
+        factored.setCITestMode(mode);
+        factored.setResidualCacheBytes(0);
+        auto graph = make_shared<Graph>(make_shared<Dataset>(columns));
+        factored.runFCI(graph, 0.05);
+        EXPECT_EQ(graph->getEdges(), expected->getEdges());
+    }
+}
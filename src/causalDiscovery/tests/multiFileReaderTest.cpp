@@ -0,0 +1,96 @@
+#include "multiFileReader.h"
+#include "CSVReader.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class MultiFileReaderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory = filesystem::temp_directory_path() / "multiFileReaderTest";
+        filesystem::remove_all(directory);
+        filesystem::create_directories(directory);
+    }
+
+    void TearDown() override {
+        filesystem::remove_all(directory);
+    }
+
+    string writeFile(const string& name, const string& content) {
+        string path = (directory / name).string();
+        ofstream(path, ios::binary) << content;
+        return path;
+    }
+
+    filesystem::path directory;
+};
+
+TEST_F(MultiFileReaderTest, ConcatenatesFilesInTheOrderGiven) {
+    string january = writeFile("month_01.csv", "speed,noise,power\n1,10,100\n2,20,200\n");
+    // Same schema with the fields in another order, plus a row the CSV reader drops
+    string february = writeFile("month_02.csv", "power,speed,noise\n300,3,30\nx,4,40\n500,5,50\n");
+    string march = writeFile("month_03.csv", "speed,noise,power\n");
+
+    vector<FileLoadStats> stats;
+    auto columns = MultiFileReader::readColumns({ february, january, march }, { "speed", "power" }, &stats, 4);
+
+    ASSERT_EQ(columns.size(), 2u);
+    EXPECT_EQ(columns[0], (Column{ 3, 5, 1, 2 }));
+    EXPECT_EQ(columns[1], (Column{ 300, 500, 100, 200 }));
+
+    // The concatenation is allocated once at its final size
+    EXPECT_EQ(columns[0].capacity(), 4u);
+
+    ASSERT_EQ(stats.size(), 3u);
+    EXPECT_EQ(stats[0].filename, february);
+    EXPECT_EQ(stats[0].numRows, 2u);
+    EXPECT_EQ(stats[1].numRows, 2u);
+    EXPECT_EQ(stats[2].numRows, 0u);
+    EXPECT_EQ(stats[1].numBytes, filesystem::file_size(january));
+    for (const auto& file : stats) {
+        EXPECT_GE(file.milliseconds, 0.0);
+    }
+
+    // A single file reads exactly as readCSVColumns does
+    EXPECT_EQ(MultiFileReader::readColumns({ february }, { "noise", "speed" }), CSVReader::readCSVColumns(february, { "noise", "speed" }));
+}
+
+TEST_F(MultiFileReaderTest, ExpandsWildcardsInTheFileName) {
+    writeFile("month_03.csv", "a\n3\n");
+    writeFile("month_01.csv", "a\n1\n");
+    writeFile("month_02.csv", "a\n2\n");
+    writeFile("month_02.txt", "a\n9\n");
+    writeFile("summary.csv", "a\n9\n");
+
+    string pattern = (directory / "month_0?.csv").string();
+    auto files = MultiFileReader::expandPattern(pattern);
+    ASSERT_EQ(files.size(), 3u);
+    EXPECT_EQ(filesystem::path(files[0]).filename(), "month_01.csv");
+    EXPECT_EQ(filesystem::path(files[2]).filename(), "month_03.csv");
+
+    EXPECT_EQ(MultiFileReader::expandPattern((directory / "*.txt").string()).size(), 1u);
+    EXPECT_EQ(MultiFileReader::expandPattern((directory / "*").string()).size(), 5u);
+
+    // Patterns and plain names can be mixed
+    auto columns = MultiFileReader::readColumns({ (directory / "summary.csv").string(), (directory / "month_*.csv").string() }, { "a" });
+    EXPECT_EQ(columns[0], (Column{ 9, 1, 2, 3 }));
+
+    // Without wildcards the name is passed through, even if the file does not exist
+    EXPECT_EQ(MultiFileReader::expandPattern("missing.csv"), vector<string>{ "missing.csv" });
+
+    EXPECT_THROW(MultiFileReader::expandPattern((directory / "year_*.csv").string()), invalid_argument);
+    EXPECT_THROW(MultiFileReader::expandPattern((directory.parent_path() / "multi*" / "month_01.csv").string()), invalid_argument);
+}
+
+TEST_F(MultiFileReaderTest, RejectsFilesWithoutTheSchema) {
+    string first = writeFile("first.csv", "a,b\n1,2\n");
+    string second = writeFile("second.csv", "a,c\n3,4\n");
+
+    EXPECT_THROW(MultiFileReader::readColumns({ first, second }, { "a", "b" }), invalid_argument);
+    EXPECT_THROW(MultiFileReader::readColumns({}, { "a" }), invalid_argument);
+}
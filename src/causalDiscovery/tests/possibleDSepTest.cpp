@@ -0,0 +1,60 @@
+#include "possibleDSep.h"
+#include "graph.h"
+#include "dataset.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+class PossibleDSepTest : public ::testing::Test {
+protected:
+    std::shared_ptr<Graph> createEmptyGraph(size_t numVertices) {
+        return std::make_shared<Graph>(std::make_shared<Dataset>(std::vector<Column>(numVertices)));
+    }
+};
+
+TEST_F(PossibleDSepTest, NonColliderWithoutTriangleBlocks) {
+    auto graph = createEmptyGraph(4);
+    graph->addDoubleDirectedEdge(0, 1);
+    graph->addDoubleDirectedEdge(1, 2);
+    graph->addDoubleDirectedEdge(2, 3);
+
+    PossibleDSep possibleDSep(*graph);
+    std::vector<int> result;
+    possibleDSep.compute(0, result);
+
+    EXPECT_EQ(result, std::vector<int>({ 1 }));
+}
+
+TEST_F(PossibleDSepTest, PathContinuesThroughCollider) {
+    // 0 -> 1 <- 2 -> 3 <- 4: both inner vertices are colliders, 2 is not one
+    auto graph = createEmptyGraph(5);
+    graph->addDirectedEdge(0, 1);
+    graph->addDirectedEdge(2, 1);
+    graph->addDirectedEdge(2, 3);
+    graph->addDirectedEdge(4, 3);
+
+    PossibleDSep possibleDSep(*graph);
+    std::vector<int> result;
+    possibleDSep.compute(0, result);
+    EXPECT_EQ(result, std::vector<int>({ 1, 2 }));
+
+    possibleDSep.compute(2, result);
+    EXPECT_EQ(result, std::vector<int>({ 0, 1, 3, 4 }));
+}
+
+TEST_F(PossibleDSepTest, PathContinuesThroughTriangle) {
+    auto graph = createEmptyGraph(5);
+    graph->addDoubleDirectedEdge(0, 1);
+    graph->addDoubleDirectedEdge(1, 2);
+    graph->addDoubleDirectedEdge(0, 2);
+    graph->addDoubleDirectedEdge(2, 3);
+    graph->addDoubleDirectedEdge(3, 4);
+    graph->addDoubleDirectedEdge(1, 3);
+
+    PossibleDSep possibleDSep(*graph);
+    std::vector<int> result;
+    possibleDSep.compute(0, result);
+
+    // <0, 1, 3> is blocked, but 0-1-2-3 only passes through triangles; no triangle leads on to 4
+    EXPECT_EQ(result, std::vector<int>({ 1, 2, 3 }));
+}
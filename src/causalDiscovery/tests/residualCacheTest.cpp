@@ -0,0 +1,176 @@
+#include "residualCache.h"
+#include "causalDiscovery.h"
+#include "correlationMatrix.h"
+#include "graph.h"
+#include "statistic.h"
+#include "threadPool.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+shared_ptr<const ResidualStatistics> residualOfSize(size_t rows) {
+    auto statistics = make_shared<ResidualStatistics>();
+    statistics->residual = Eigen::VectorXd::Zero(rows);
+    return statistics;
+}
+
+vector<Column> createData(size_t numRows) {
+    mt19937 rng(21);
+    normal_distribution<double> noise(0.0, 1.0);
+    vector<Column> columns(6, Column(numRows));
+    for (size_t r = 0; r < numRows; ++r) {
+        columns[0][r] = noise(rng);
+        columns[1][r] = 0.7 * columns[0][r] + noise(rng);
+        columns[2][r] = 0.5 * columns[1][r] + noise(rng);
+        columns[3][r] = 0.4 * columns[2][r] + 0.3 * columns[0][r] + noise(rng);
+        columns[4][r] = 0.6 * columns[3][r] + noise(rng);
+        columns[5][r] = noise(rng);
+    }
+    return columns;
+}
+
+} // namespace
+
+TEST(ResidualCacheTest, EvictsLeastRecentlyUsedEntries) {
+    // A single shard keeps the eviction order exactly least recently used
+    size_t entryBytes = residualOfSize(100)->bytes();
+    ResidualCache cache(3 * entryBytes + 3 * 200, 1);
+
+    cache.store(0, vector<int>{ 1, 2 }, residualOfSize(100));
+    cache.store(1, vector<int>{ 2 }, residualOfSize(100));
+    cache.store(2, {}, residualOfSize(100));
+    EXPECT_EQ(cache.size(), 3u);
+
+    // Touching the oldest entry makes (1, {2}) the least recently used
+    EXPECT_NE(cache.lookup(0, vector<int>{ 1, 2 }), nullptr);
+    cache.store(3, vector<int>{ 0 }, residualOfSize(100));
+    EXPECT_EQ(cache.size(), 3u);
+    EXPECT_EQ(cache.lookup(1, vector<int>{ 2 }), nullptr);
+    EXPECT_NE(cache.lookup(0, vector<int>{ 1, 2 }), nullptr);
+    EXPECT_EQ(cache.getEvictions(), 1u);
+    EXPECT_LE(cache.getBytes(), cache.getMaxBytes());
+
+    // Larger than the whole budget: not stored
+    cache.store(4, {}, residualOfSize(100000));
+    EXPECT_EQ(cache.lookup(4, {}), nullptr);
+
+    cache.setMaxBytes(0);
+    EXPECT_FALSE(cache.isEnabled());
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.getBytes(), 0u);
+}
+
+TEST(ResidualCacheTest, ShardsShareOneBudget) {
+    size_t entryBytes = residualOfSize(100)->bytes();
+    ResidualCache cache(10 * entryBytes + 10 * 100, 8);
+
+    for (int v = 0; v < 40; ++v) {
+        cache.store(v, vector<int>{ 40 + v % 3 }, residualOfSize(100));
+        EXPECT_LE(cache.getBytes(), cache.getMaxBytes());
+    }
+    EXPECT_EQ(cache.size(), 10u);
+    EXPECT_EQ(cache.getEvictions(), 30u);
+
+    // The most recent entry always survives, whichever shard it went to
+    EXPECT_NE(cache.lookup(39, vector<int>{ 40 + 39 % 3 }), nullptr);
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.getBytes(), 0u);
+    EXPECT_THROW(ResidualCache(1024, 0), invalid_argument);
+}
+
+TEST(ResidualCacheTest, ConcurrentStoresAndLookupsKeepEveryEntry) {
+    // The budget holds every entry, so nothing is evicted whatever order the shards see
+    const size_t numTasks = 64;
+    const int setsPerTask = 20;
+    size_t entryBytes = residualOfSize(10)->bytes();
+    ResidualCache cache(numTasks * setsPerTask * (entryBytes + 1024));
+    ThreadPool pool(8);
+
+    pool.parallelFor(numTasks, [&](size_t task) {
+        int v = static_cast<int>(task);
+        for (int k = 0; k < setsPerTask; ++k) {
+            auto statistics = make_shared<ResidualStatistics>();
+            statistics->residual = Eigen::VectorXd::Constant(10, v * setsPerTask + k);
+            cache.store(v, vector<int>{ 100 + k, 200 + v }, statistics);
+        }
+        for (int k = 0; k < setsPerTask; ++k) {
+            auto statistics = cache.lookup(v, vector<int>{ 100 + k, 200 + v });
+            ASSERT_NE(statistics, nullptr);
+            EXPECT_EQ(statistics->residual[0], v * setsPerTask + k);
+            EXPECT_EQ(cache.lookup(v, vector<int>{ 100 + k }), nullptr);
+        }
+    });
+
+    EXPECT_EQ(cache.size(), numTasks * setsPerTask);
+    EXPECT_EQ(cache.getHits(), numTasks * setsPerTask);
+    EXPECT_EQ(cache.getMisses(), numTasks * setsPerTask);
+    EXPECT_EQ(cache.getEvictions(), 0u);
+    EXPECT_LE(cache.getBytes(), cache.getMaxBytes());
+    for (int v = 0; v < static_cast<int>(numTasks); ++v) {
+        for (int k = 0; k < setsPerTask; ++k) {
+            auto statistics = cache.lookup(v, vector<int>{ 100 + k, 200 + v });
+            ASSERT_NE(statistics, nullptr);
+            EXPECT_EQ(statistics->residual[9], v * setsPerTask + k);
+        }
+    }
+}
+
+TEST(ResidualCacheTest, CachedTestsMatchUncachedTests) {
+    auto data = make_shared<Dataset>(createData(800));
+    CorrelationMatrix correlations(*data);
+    ResidualCache regressionCache;
+    ResidualCache inPlaceCache;
+    ResidualCache covarianceCache;
+
+    for (auto statistic : { CITestStatistic::TStatistic, CITestStatistic::FisherZ }) {
+        for (const vector<int>& conditioningSet : vector<vector<int>>{ {}, { 1 }, { 1, 2 }, { 0, 2, 5 } }) {
+            for (int i = 0; i < 6; ++i) {
+                for (int j = i + 1; j < 6; ++j) {
+                    if (ranges::count(conditioningSet, i) || ranges::count(conditioningSet, j)) {
+                        continue;
+                    }
+                    EXPECT_EQ(Statistic::testConditionalIndependence(data, i, j, conditioningSet, regressionCache, statistic),
+                        Statistic::testConditionalIndependence(data, i, j, conditioningSet, statistic));
+                    EXPECT_NEAR(Statistic::testConditionalIndependenceInPlace(*data, i, j, conditioningSet, inPlaceCache, statistic),
+                        Statistic::testConditionalIndependenceInPlace(*data, i, j, conditioningSet, statistic), 1e-9);
+                    EXPECT_NEAR(Statistic::testConditionalIndependence(correlations, i, j, conditioningSet, covarianceCache, statistic),
+                        Statistic::testConditionalIndependence(correlations, i, j, conditioningSet, statistic), 1e-9);
+                }
+            }
+        }
+    }
+
+    // Each variable is regressed once per conditioning set; every other test is a hit
+    EXPECT_GT(regressionCache.getHits(), regressionCache.getMisses());
+    EXPECT_EQ(regressionCache.size(), 5u + 4u + 3u);
+}
+
+TEST(ResidualCacheTest, DiscoveryResultDoesNotDependOnTheCache) {
+    auto columns = createData(1000);
+    for (auto mode : { CITestMode::Regression, CITestMode::InPlace, CITestMode::Covariance }) {
+        auto cachedGraph = make_shared<Graph>(make_shared<Dataset>(columns));
+        auto uncachedGraph = make_shared<Graph>(make_shared<Dataset>(columns));
+
+        CausalDiscovery cached;
+        cached.setCITestMode(mode);
+        cached.runFCI(cachedGraph, 0.05);
+
+        CausalDiscovery uncached;
+        uncached.setCITestMode(mode);
+        uncached.setResidualCacheBytes(0);
+        uncached.runFCI(uncachedGraph, 0.05);
+
+        EXPECT_EQ(cachedGraph->getEdges(), uncachedGraph->getEdges());
+        EXPECT_GT(cached.getResidualCache().size(), 0u);
+        EXPECT_EQ(uncached.getResidualCache().size(), 0u);
+    }
+}
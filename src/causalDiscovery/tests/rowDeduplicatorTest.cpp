@@ -0,0 +1,116 @@
+#include "rowDeduplicator.h"
+#include "correlationMatrix.h"
+#include "statistic.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+class RowDeduplicatorTest : public ::testing::Test {
+protected:
+    // Rows drawn from a small pool of specs, the way registration records repeat
+    vector<Column> createRepeatedRows(size_t numRows, size_t numDistinct) {
+        mt19937 rng(41);
+        normal_distribution<double> noise(0.0, 1.0);
+
+        vector<Column> pool(4, Column(numDistinct));
+        for (size_t d = 0; d < numDistinct; ++d) {
+            pool[0][d] = round(noise(rng) * 10.0);
+            pool[1][d] = round(0.7 * pool[0][d] + noise(rng) * 5.0);
+            pool[2][d] = round(0.5 * pool[1][d] + noise(rng) * 5.0);
+            pool[3][d] = round(0.4 * pool[2][d] + 0.3 * pool[0][d] + noise(rng) * 5.0);
+        }
+
+        uniform_int_distribution<size_t> pick(0, numDistinct - 1);
+        vector<Column> columns(4, Column(numRows));
+        for (size_t r = 0; r < numRows; ++r) {
+            size_t d = pick(rng);
+            for (size_t c = 0; c < 4; ++c) {
+                columns[c][r] = pool[c][d];
+            }
+        }
+        return columns;
+    }
+};
+
+TEST_F(RowDeduplicatorTest, CollapsesRepeatedRowsIntoWeights) {
+    double nan = numeric_limits<double>::quiet_NaN();
+    Dataset data(vector<Column>{
+        { 1, 2, 1, 0.0, 1, -0.0, nan, nan },
+        { 5, 6, 5, 7, 6, 7, 8, 8 } });
+
+    auto unique = RowDeduplicator::deduplicate(data);
+
+    ASSERT_EQ(unique->getNumOfColumns(), 2u);
+    auto first = unique->getColumnView(0);
+    auto second = unique->getColumnView(1);
+    ASSERT_EQ(first.size(), 5u);
+    EXPECT_EQ(Column(second.begin(), second.end()), (Column{ 5, 6, 7, 6, 8 }));
+    EXPECT_EQ(first[3], 1);
+    EXPECT_TRUE(isnan(first[4]));
+
+    auto weights = unique->getRowWeights();
+    EXPECT_EQ(Column(weights.begin(), weights.end()), (Column{ 2, 1, 2, 1, 2 }));
+    EXPECT_EQ(unique->getSampleSize(), 8u);
+    EXPECT_NE(unique->getValidity(0), nullptr);
+
+    // Weighted input adds up the weights of the rows it merges
+    Dataset weighted(vector<Column>{ { 1, 2, 1 } }, Column{ 3, 1, 2 }, DatasetStorage::Contiguous);
+    auto merged = RowDeduplicator::deduplicate(weighted, DatasetStorage::Contiguous);
+    EXPECT_EQ(merged->getStorage(), DatasetStorage::Contiguous);
+    EXPECT_EQ(Column(merged->getRowWeights().begin(), merged->getRowWeights().end()), (Column{ 5, 1 }));
+    EXPECT_EQ(merged->getSampleSize(), 6u);
+}
+
+TEST_F(RowDeduplicatorTest, WeightedStatisticsMatchTheRepeatedRows) {
+    auto columns = createRepeatedRows(5000, 60);
+    auto data = make_shared<Dataset>(columns);
+    shared_ptr<const Dataset> unique = RowDeduplicator::deduplicate(*data);
+
+    ASSERT_LE(unique->getNumOfColumns(), 4u);
+    EXPECT_LE(unique->getColumnView(0).size(), 60u);
+    EXPECT_EQ(unique->getSampleSize(), 5000u);
+
+    for (int c = 0; c < 4; ++c) {
+        EXPECT_NEAR(unique->getColumnProfile(c).mean, data->getColumnProfile(c).mean, 1e-9);
+        EXPECT_NEAR(unique->getColumnProfile(c).variance, data->getColumnProfile(c).variance, 1e-7);
+    }
+
+    CorrelationMatrix correlations(*data);
+    CorrelationMatrix uniqueCorrelations(*unique);
+    EXPECT_EQ(uniqueCorrelations.getNumRows(), 5000u);
+
+    for (auto statistic : { CITestStatistic::TStatistic, CITestStatistic::FisherZ }) {
+        for (const vector<int>& conditioningSet : vector<vector<int>>{ {}, { 1 }, { 1, 2 } }) {
+            double expected = Statistic::testConditionalIndependence(data, 0, 3, conditioningSet, statistic);
+            EXPECT_NEAR(Statistic::testConditionalIndependence(unique, 0, 3, conditioningSet, statistic), expected, 1e-9);
+            EXPECT_NEAR(Statistic::testConditionalIndependenceInPlace(*unique, 0, 3, conditioningSet, statistic), expected, 1e-9);
+            EXPECT_NEAR(Statistic::testConditionalIndependence(uniqueCorrelations, 0, 3, conditioningSet, statistic),
+                Statistic::testConditionalIndependence(correlations, 0, 3, conditioningSet, statistic), 1e-9);
+        }
+    }
+
+    // Test-wise deletion weighs the surviving rows too
+    columns[2][7] = numeric_limits<double>::quiet_NaN();
+    auto withMissing = make_shared<Dataset>(columns);
+    auto uniqueWithMissing = RowDeduplicator::deduplicate(*withMissing);
+    for (const vector<int>& conditioningSet : vector<vector<int>>{ {}, { 2 }, { 1, 2 } }) {
+        EXPECT_NEAR(Statistic::testConditionalIndependenceTestWise(*uniqueWithMissing, 2, 3, conditioningSet),
+            Statistic::testConditionalIndependenceTestWise(*withMissing, 2, 3, conditioningSet), 1e-9);
+    }
+}
+
+TEST_F(RowDeduplicatorTest, DatasetRejectsInvalidWeights) {
+    EXPECT_THROW(Dataset(vector<Column>{ { 1, 2 } }, Column{ 1, 0 }), invalid_argument);
+    EXPECT_THROW(Dataset(vector<Column>{ { 1, 2 } }, Column{ 1, 1.5 }), invalid_argument);
+    EXPECT_THROW(Dataset(vector<Column>{ { 1, 2, 3 } }, Column{ 1, 2 }), invalid_argument);
+
+    Dataset data(vector<Column>{ { 1, 2 } }, Column{ 2, 3 });
+    EXPECT_THROW(data.addColumn(Column{ 1, 2, 3 }), invalid_argument);
+    EXPECT_EQ(data.getSampleSize(), 5u);
+}
@@ -0,0 +1,64 @@
+#include "sepsetStore.h"
+#include "causalDiscovery.h"
+#include "graph.h"
+#include "dataset.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+TEST(SepsetStoreTest, RecordsSetsPerUnorderedPair) {
+    SepsetStore store;
+    store.reset(5);
+
+    store.record(3, 1, { 0, 4 });
+    store.record(0, 2, {});
+
+    EXPECT_TRUE(store.hasSepset(1, 3));
+    EXPECT_TRUE(store.hasSepset(3, 1));
+    EXPECT_TRUE(store.contains(1, 3, 4));
+    EXPECT_FALSE(store.contains(1, 3, 2));
+
+    EXPECT_TRUE(store.hasSepset(2, 0));
+    EXPECT_TRUE(store.getSepset(2, 0).empty());
+
+    EXPECT_FALSE(store.hasSepset(0, 1));
+    EXPECT_EQ(store.size(), 2);
+}
+
+TEST(SepsetStoreTest, ReRecordingReplacesTheSet) {
+    SepsetStore store;
+    store.reset(4);
+
+    store.record(0, 1, { 2 });
+    store.record(1, 0, { 3 });
+
+    auto sepset = store.getSepset(0, 1);
+    ASSERT_EQ(sepset.size(), 1);
+    EXPECT_EQ(sepset[0], 3);
+    EXPECT_EQ(store.size(), 1);
+}
+
+TEST(SepsetStoreTest, ColliderIsOrientedFromRecordedSepset) {
+    // Z (0) is a common effect of the independent X (1) and Y (2)
+    std::mt19937 rng(13);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::vector<Column> columns(3, Column(500));
+    for (size_t r = 0; r < 500; ++r) {
+        columns[1][r] = noise(rng);
+        columns[2][r] = noise(rng);
+        columns[0][r] = columns[1][r] + columns[2][r] + 0.5 * noise(rng);
+    }
+    auto graph = std::make_shared<Graph>(std::make_shared<Dataset>(columns));
+
+    CausalDiscovery fci;
+    fci.runFCI(graph, 0.05);
+
+    ASSERT_TRUE(fci.getSepsets().hasSepset(1, 2));
+    EXPECT_TRUE(fci.getSepsets().getSepset(1, 2).empty());
+
+    EXPECT_TRUE(graph->hasDirectedEdge(1, 0));
+    EXPECT_TRUE(graph->hasDirectedEdge(2, 0));
+    EXPECT_FALSE(graph->hasDirectedEdge(0, 1));
+    EXPECT_FALSE(graph->hasDirectedEdge(0, 2));
+}
@@ -1,9 +1,15 @@
 #include "statistic.h"
 #include "dataset.h"
 #include <gtest/gtest.h>
+#include <boost/math/distributions/normal.hpp>
+#include <boost/math/distributions/students_t.hpp>
+#include <algorithm>
+#include <cmath>
 #include <vector>
-#include <set>
 #include <memory>
+#include <limits>
+#include <random>
+#include <stdexcept>
 
 using namespace std;
 
@@ -12,7 +18,7 @@ struct TestCase {
     vector<vector<double>> data;
     int i;
     int j;
-    set<int> conditioningSet;
+    vector<int> conditioningSet;
     bool expected_independence;
 };
 
@@ -95,3 +101,189 @@ INSTANTIATE_TEST_SUITE_P(
             0, 1, { 2 }, false}
     )
 );
+
+TEST(StatisticInPlaceTest, MatchesRegressionPathInBothStorageModes) {
+    mt19937 rng(7);
+    normal_distribution<double> noise(0.0, 1.0);
+
+    size_t num_rows = 400;
+    vector<Column> columns(6, Column(num_rows));
+    for (size_t r = 0; r < num_rows; ++r) {
+        columns[0][r] = noise(rng);
+        columns[1][r] = 0.6 * columns[0][r] + noise(rng) + 3.0;
+        columns[2][r] = 0.5 * columns[1][r] + noise(rng);
+        columns[3][r] = noise(rng) - 2.0;
+        columns[4][r] = 0.4 * columns[2][r] + 0.3 * columns[3][r] + noise(rng);
+        columns[5][r] = noise(rng);
+    }
+
+    for (auto storage : { DatasetStorage::Columns, DatasetStorage::Contiguous }) {
+        auto data = make_shared<Dataset>(columns, storage);
+        for (auto statistic : { CITestStatistic::TStatistic, CITestStatistic::FisherZ }) {
+            for (const vector<int>& conditioningSet : vector<vector<int>>{ {}, { 1 }, { 1, 3 }, { 1, 3, 5 }, { 1, 2, 3, 5 } }) {
+                double p_regression = Statistic::testConditionalIndependence(data, 0, 4, conditioningSet, statistic);
+                double p_in_place = Statistic::testConditionalIndependenceInPlace(*data, 0, 4, conditioningSet, statistic);
+                EXPECT_NEAR(p_regression, p_in_place, 1e-6);
+            }
+        }
+    }
+}
+
+TEST(StatisticInPlaceTest, FollowsRegressionConventions) {
+    Dataset data(vector<Column>{
+        { 1, 2, 3, 4, 5 },
+        { 2, 4, 6, 8, 11 },
+        { 1, 1, 1, 1, 1 },
+        { 2, 4, 6, 8, 10 } });
+
+    EXPECT_DOUBLE_EQ(Statistic::testConditionalIndependenceInPlace(data, 0, 2, {}), 1.0);
+    EXPECT_DOUBLE_EQ(Statistic::testConditionalIndependenceInPlace(data, 0, 1, vector<int>{ 2 }), 1e-10);
+    EXPECT_DOUBLE_EQ(Statistic::testConditionalIndependenceInPlace(data, 1, 0, vector<int>{ 3 }), Statistic::testConditionalIndependence(make_shared<Dataset>(data), 1, 0, vector<int>{ 3 }));
+    EXPECT_THROW(Statistic::testConditionalIndependenceInPlace(data, 0, 4, {}), runtime_error);
+    EXPECT_THROW(Statistic::testConditionalIndependenceInPlace(data, 0, 1, vector<int>{ 2, 3, 4 }), runtime_error);
+}
+
+TEST(StatisticDegenerateTest, ProfilesShortCircuitDegenerateTests) {
+    double nan = numeric_limits<double>::quiet_NaN();
+    auto data = make_shared<Dataset>(vector<Column>{
+        { 1, 2.5, 3, 4.5, 5, 7 },
+        { 1, 2.5, 3, 4.5, 5, 7 },
+        { 2, 2, 2, 2, 2, 2 },
+        { 1, nan, 0, 1, 2, 3 },
+        { 3, 1, 4, 1, 5, 9 } });
+
+    for (auto statistic : { CITestStatistic::TStatistic, CITestStatistic::FisherZ }) {
+        // Duplicated columns are perfectly dependent, with or without conditioning
+        EXPECT_DOUBLE_EQ(Statistic::testConditionalIndependence(data, 0, 1, {}, statistic), 1e-10);
+        EXPECT_DOUBLE_EQ(Statistic::testConditionalIndependence(data, 0, 1, vector<int>{ 4 }, statistic), 1e-10);
+
+        // A constant column is independent of everything, and singular as a conditioning column
+        EXPECT_DOUBLE_EQ(Statistic::testConditionalIndependence(data, 2, 4, {}, statistic), 1.0);
+        EXPECT_DOUBLE_EQ(Statistic::testConditionalIndependence(data, 0, 4, vector<int>{ 2 }, statistic), 1e-10);
+
+        // NaN makes the correlation undefined
+        EXPECT_DOUBLE_EQ(Statistic::testConditionalIndependence(data, 0, 3, {}, statistic), 1.0);
+        EXPECT_DOUBLE_EQ(Statistic::testConditionalIndependenceInPlace(*data, 0, 4, vector<int>{ 3 }, statistic), 1.0);
+    }
+
+    EXPECT_THROW(Statistic::testConditionalIndependence(data, 0, 4, vector<int>{ 7 }), runtime_error);
+}
+
+TEST(StatisticTestWiseDeletionTest, MatchesTheTestOnTheRowsWithoutMissingValues) {
+    mt19937 rng(11);
+    normal_distribution<double> noise(0.0, 1.0);
+    bernoulli_distribution missing(0.1);
+    double nan = numeric_limits<double>::quiet_NaN();
+
+    size_t num_rows = 600;
+    vector<Column> columns(5, Column(num_rows));
+    for (size_t r = 0; r < num_rows; ++r) {
+        columns[0][r] = noise(rng);
+        columns[1][r] = 0.6 * columns[0][r] + noise(rng) + 1.0;
+        columns[2][r] = 0.5 * columns[1][r] + noise(rng);
+        columns[3][r] = noise(rng);
+        columns[4][r] = 0.4 * columns[2][r] + noise(rng);
+    }
+    auto complete = make_shared<Dataset>(columns);
+
+    // Rows 128-255 stay complete so whole 64-row words take the dense path
+    for (size_t r = 0; r < num_rows; ++r) {
+        for (int c : { 0, 2, 4 }) {
+            if ((r < 128 || r >= 256) && missing(rng)) {
+                columns[c][r] = nan;
+            }
+        }
+    }
+    auto data = make_shared<Dataset>(columns, DatasetStorage::Contiguous);
+
+    for (auto statistic : { CITestStatistic::TStatistic, CITestStatistic::FisherZ }) {
+        for (const vector<int>& conditioningSet : vector<vector<int>>{ {}, { 2 }, { 1, 2 }, { 1, 2, 3 } }) {
+            // Reference: the rows where 0, 4 and the conditioning set are all present, copied out
+            vector<int> tested = { 0, 4 };
+            tested.insert(tested.end(), conditioningSet.begin(), conditioningSet.end());
+            vector<Column> rows(tested.size());
+            for (size_t r = 0; r < num_rows; ++r) {
+                if (all_of(tested.begin(), tested.end(), [&](int c) { return !isnan(columns[c][r]); })) {
+                    for (size_t t = 0; t < tested.size(); ++t) {
+                        rows[t].push_back(columns[tested[t]][r]);
+                    }
+                }
+            }
+            vector<int> renumbered;
+            for (size_t t = 2; t < tested.size(); ++t) {
+                renumbered.push_back(static_cast<int>(t));
+            }
+            double expected = Statistic::testConditionalIndependenceInPlace(Dataset(rows), 0, 1, renumbered, statistic);
+
+            EXPECT_TRUE(Statistic::hasMissingValues(*data, 0, 4, conditioningSet));
+            EXPECT_NEAR(Statistic::testConditionalIndependenceTestWise(*data, 0, 4, conditioningSet, statistic), expected, 1e-9);
+
+            // Without deletion the NaNs make every such test report independence
+            EXPECT_DOUBLE_EQ(Statistic::testConditionalIndependenceInPlace(*data, 0, 4, conditioningSet, statistic), 1.0);
+        }
+    }
+
+    // Tests whose columns are complete are the in-place test
+    EXPECT_FALSE(Statistic::hasMissingValues(*data, 1, 3, {}));
+    EXPECT_DOUBLE_EQ(Statistic::testConditionalIndependenceTestWise(*data, 1, 3, {}), Statistic::testConditionalIndependenceInPlace(*complete, 1, 3, {}));
+    EXPECT_THROW(Statistic::testConditionalIndependenceTestWise(*data, 0, 4, vector<int>{ 9 }), runtime_error);
+}
+
+TEST(StatisticDecisionTest, CriticalCorrelationReproducesTheAlphaDecision) {
+    for (auto statistic : { CITestStatistic::TStatistic, CITestStatistic::FisherZ }) {
+        CriticalCorrelation critical(0.05, statistic);
+
+        // At the critical correlation the p-value is alpha
+        for (size_t depth : { 0u, 1u, 3u }) {
+            double r = critical.get(200, depth);
+            ASSERT_GT(r, 0.0);
+            ASSERT_LT(r, 1.0);
+            double t = r * sqrt((200.0 - depth - 2) / (1 - r * r));
+            double z = atanh(r) * sqrt(200.0 - depth - 3);
+            boost::math::students_t tDist(200.0 - depth - 2);
+            double p = statistic == CITestStatistic::FisherZ ? 2 * boost::math::cdf(boost::math::complement(boost::math::normal(), z))
+                                                             : 2 * boost::math::cdf(boost::math::complement(tDist, t));
+            EXPECT_NEAR(p, 0.05, 1e-9);
+        }
+        EXPECT_TRUE(std::isinf(critical.get(3, 1)));
+
+        // The precomputed table holds the same values and falls back outside its sizes
+        CriticalCorrelation table(0.05, statistic, 200, 2);
+        for (size_t depth : { 0u, 1u, 2u, 3u }) {
+            EXPECT_EQ(table.get(200, depth), critical.get(200, depth));
+            EXPECT_EQ(table.get(150, depth), critical.get(150, depth));
+        }
+    }
+    EXPECT_THROW(CriticalCorrelation(0.0, CITestStatistic::TStatistic), invalid_argument);
+
+    // Every test mode decides as its exact p-value does
+    mt19937 rng(24);
+    normal_distribution<double> noise(0.0, 1.0);
+    vector<Column> columns(5, Column(150));
+    for (size_t r = 0; r < 150; ++r) {
+        columns[0][r] = noise(rng);
+        for (size_t c = 1; c < 5; ++c) {
+            columns[c][r] = 0.25 * columns[c - 1][r] + noise(rng);
+        }
+    }
+    auto data = make_shared<Dataset>(columns);
+    CorrelationMatrix correlations(*data);
+
+    for (auto statistic : { CITestStatistic::TStatistic, CITestStatistic::FisherZ }) {
+        for (double alpha : { 0.01, 0.05, 0.2 }) {
+            CriticalCorrelation critical(alpha, statistic);
+            for (const vector<int>& conditioningSet : vector<vector<int>>{ {}, { 2 }, { 1, 2 }, { 1, 2, 3 } }) {
+                for (int j : { 3, 4 }) {
+                    if (ranges::count(conditioningSet, j)) {
+                        continue;
+                    }
+                    bool independent = Statistic::testConditionalIndependence(data, 0, j, conditioningSet, statistic) > alpha;
+                    EXPECT_EQ(Statistic::testConditionalIndependence(data, 0, j, conditioningSet, statistic, &critical) > alpha, independent);
+                    EXPECT_EQ(Statistic::testConditionalIndependenceInPlace(*data, 0, j, conditioningSet, statistic, &critical) > alpha, independent);
+                    EXPECT_EQ(Statistic::testConditionalIndependence(correlations, 0, j, conditioningSet, statistic, &critical) > alpha,
+                        Statistic::testConditionalIndependence(correlations, 0, j, conditioningSet, statistic) > alpha);
+                }
+            }
+        }
+    }
+}
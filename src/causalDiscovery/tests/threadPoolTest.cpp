@@ -0,0 +1,64 @@
+#include "threadPool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+TEST(ThreadPoolTest, RunsEveryIndexExactlyOnce) {
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.getNumThreads(), 4);
+
+    std::vector<std::atomic<int>> calls(1000);
+    pool.parallelFor(calls.size(), [&](size_t k) { calls[k]++; });
+
+    for (const auto& count : calls) {
+        EXPECT_EQ(count.load(), 1);
+    }
+}
+
+TEST(ThreadPoolTest, CanBeReusedAcrossLoops) {
+    ThreadPool pool(3);
+    std::atomic<size_t> sum = 0;
+
+    for (int round = 0; round < 50; ++round) {
+        pool.parallelFor(10, [&](size_t k) { sum += k; });
+    }
+
+    EXPECT_EQ(sum.load(), 50 * 45);
+}
+
+TEST(ThreadPoolTest, PassesEachTaskTheIndexOfItsWorker) {
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> perWorker(pool.getNumThreads());
+    std::atomic<int> outOfRange = 0;
+
+    pool.parallelFor(1000, [&](size_t, size_t worker) {
+        if (worker >= perWorker.size()) {
+            outOfRange++;
+            return;
+        }
+        perWorker[worker]++;
+    });
+
+    EXPECT_EQ(outOfRange.load(), 0);
+    int total = 0;
+    for (const auto& count : perWorker) {
+        total += count.load();
+    }
+    EXPECT_EQ(total, 1000);
+}
+
+TEST(ThreadPoolTest, RethrowsTaskException) {
+    ThreadPool pool(2);
+
+    EXPECT_THROW(pool.parallelFor(100, [](size_t k) {
+        if (k == 17) {
+            throw std::runtime_error("task failed");
+        }
+    }), std::runtime_error);
+
+    // The pool stays usable after a failed loop
+    std::atomic<int> calls = 0;
+    pool.parallelFor(5, [&](size_t) { calls++; });
+    EXPECT_EQ(calls.load(), 5);
+}
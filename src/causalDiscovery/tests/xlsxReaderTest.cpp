@@ -0,0 +1,142 @@
+#include "XLSXReader.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+class XLSXReaderTest : public ::testing::Test {
+protected:
+    // Writes an uncompressed ZIP archive; real workbooks are deflated, which the vehicle test covers
+    string writeArchive(const string& name, const vector<pair<string, string>>& entries) {
+        string path = (filesystem::temp_directory_path() / name).string();
+        string archive;
+        string directory;
+
+        for (const auto& [entryName, contents] : entries) {
+            uint32_t offset = static_cast<uint32_t>(archive.size());
+            uint32_t crc = crc32(contents);
+            uint32_t size = static_cast<uint32_t>(contents.size());
+            uint16_t nameLength = static_cast<uint16_t>(entryName.size());
+
+            put32(archive, 0x04034b50); put16(archive, 20); put16(archive, 0); put16(archive, 0);
+            put32(archive, 0); put32(archive, crc); put32(archive, size); put32(archive, size);
+            put16(archive, nameLength); put16(archive, 0);
+            archive += entryName + contents;
+
+            put32(directory, 0x02014b50); put16(directory, 20); put16(directory, 20); put16(directory, 0); put16(directory, 0);
+            put32(directory, 0); put32(directory, crc); put32(directory, size); put32(directory, size);
+            put16(directory, nameLength); put16(directory, 0); put16(directory, 0); put16(directory, 0); put16(directory, 0);
+            put32(directory, 0); put32(directory, offset);
+            directory += entryName;
+        }
+
+        uint32_t directoryOffset = static_cast<uint32_t>(archive.size());
+        archive += directory;
+        put32(archive, 0x06054b50); put16(archive, 0); put16(archive, 0);
+        put16(archive, static_cast<uint16_t>(entries.size())); put16(archive, static_cast<uint16_t>(entries.size()));
+        put32(archive, static_cast<uint32_t>(directory.size())); put32(archive, directoryOffset); put16(archive, 0);
+
+        ofstream(path, ios::binary) << archive;
+        return path;
+    }
+
+    string writeWorkbook(const string& name, const string& sheetData) {
+        return writeArchive(name, {
+            { "xl/workbook.xml",
+              "<?xml version=\"1.0\" encoding=\"UTF-8\"?><workbook xmlns:r=\"r\"><sheets>"
+              "<sheet name=\"Data\" sheetId=\"1\" r:id=\"rId1\"/><sheet name=\"Summary\" sheetId=\"2\" r:id=\"rId2\"/>"
+              "</sheets></workbook>" },
+            { "xl/_rels/workbook.xml.rels",
+              "<Relationships>"
+              "<Relationship Id=\"rId1\" Type=\"t/worksheet\" Target=\"worksheets/sheet1.xml\"/>"
+              "<Relationship Id=\"rId2\" Type=\"t/worksheet\" Target=\"/xl/worksheets/sheet2.xml\"/>"
+              "<Relationship Id=\"rId3\" Type=\"t/sharedStrings\" Target=\"sharedStrings.xml\"/>"
+              "</Relationships>" },
+            { "xl/sharedStrings.xml",
+              "<sst><si><t>speed</t></si><si><r><t>tempe</t></r><r><t>rature</t></r></si><si><t>n/a</t></si>"
+              "<si><t>A &amp; B</t></si></sst>" },
+            { "xl/worksheets/sheet1.xml", "<worksheet><sheetData>" + sheetData + "</sheetData><rowBreaks/></worksheet>" },
+            { "xl/worksheets/sheet2.xml",
+              "<worksheet><sheetData><row><c t=\"inlineStr\"><is><t>total</t></is></c></row><row><c><v>42</v></c></row></sheetData></worksheet>" } });
+    }
+
+private:
+    static void put16(string& out, uint16_t value) {
+        out += static_cast<char>(value & 0xFF);
+        out += static_cast<char>(value >> 8);
+    }
+
+    static void put32(string& out, uint32_t value) {
+        put16(out, static_cast<uint16_t>(value & 0xFFFF));
+        put16(out, static_cast<uint16_t>(value >> 16));
+    }
+
+    static uint32_t crc32(const string& data) {
+        uint32_t crc = 0xFFFFFFFF;
+        for (unsigned char byte : data) {
+            crc ^= byte;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+            }
+        }
+        return ~crc;
+    }
+};
+
+TEST_F(XLSXReaderTest, ReadsSelectedColumnsBelowTheHeaderRow) {
+    string path = writeWorkbook("xlsxReaderTest_small.xlsx",
+        "<row r=\"1\"><c r=\"A1\" t=\"inlineStr\"><is><t>Monthly export</t></is></c></row>"
+        "<row r=\"2\"><c r=\"A2\" t=\"s\"><v>0</v></c><c r=\"B2\" t=\"inlineStr\"><is><t> id </t></is></c>"
+        "<c r=\"C2\" t=\"s\"><v>1</v></c><c r=\"D2\" t=\"s\"><v>3</v></c></row>"
+        "<row r=\"3\"><c r=\"A3\"><v>1.5</v></c><c r=\"B3\"><v>7</v></c><c r=\"C3\"><v>-20</v></c><c r=\"D3\"><v>1</v></c></row>"
+        "<row r=\"4\"><c r=\"A4\"><v>2</v></c><c r=\"C4\" t=\"s\"><v>2</v></c></row>"
+        "<row r=\"5\"><c r=\"A5\"><v>3</v></c></row>"
+        "<row r=\"6\"/>"
+        "<row r=\"7\"><c><v>4e2</v></c><c><v>8</v></c><c t=\"b\"><v>1</v></c><c t=\"e\"><v>#DIV/0!</v></c></row>"
+        "<row r=\"8\"><c r=\"B8\"><v>9</v></c><c r=\"C8\"><v>0.25</v></c><c r=\"A8\"><v>5</v></c></row>");
+
+    auto columns = XLSXReader::readXLSXColumns(path, { "temperature", "speed" });
+
+    ASSERT_EQ(columns.size(), 2u);
+    EXPECT_EQ(columns[0], (Column{ -20, 1, 0.25 }));
+    EXPECT_EQ(columns[1], (Column{ 1.5, 400, 5 }));
+
+    // Entities are decoded and header cells are trimmed
+    auto named = XLSXReader::readXLSXColumns(path, { "A & B", "id" });
+    EXPECT_EQ(named[0], (Column{ 1 }));
+    EXPECT_EQ(named[1], (Column{ 7 }));
+
+    // Other sheets by name; this one is reached through an absolute relationship target
+    EXPECT_EQ(XLSXReader::readXLSXColumns(path, { "total" }, "Summary")[0], (Column{ 42 }));
+    EXPECT_THROW(XLSXReader::readXLSXColumns(path, { "total" }), invalid_argument);
+
+    EXPECT_THROW(XLSXReader::readXLSXColumns(path, { "speed", "pressure" }), invalid_argument);
+    EXPECT_THROW(XLSXReader::readXLSXColumns(path, { "speed", "speed" }), invalid_argument);
+    EXPECT_THROW(XLSXReader::readXLSXColumns(path, { "speed" }, "Missing"), invalid_argument);
+}
+
+TEST_F(XLSXReaderTest, RejectsFilesThatAreNotWorkbooks) {
+    string csvPath = (filesystem::temp_directory_path() / "xlsxReaderTest_plain.csv").string();
+    ofstream(csvPath) << "a,b\n1,2\n";
+    EXPECT_THROW(XLSXReader::readXLSXColumns(csvPath, { "a" }), runtime_error);
+
+    string archivePath = writeArchive("xlsxReaderTest_other.zip", { { "readme.txt", "hello" } });
+    EXPECT_THROW(XLSXReader::readXLSXColumns(archivePath, { "a" }), runtime_error);
+}
+
+TEST_F(XLSXReaderTest, VehicleWorkbookMatchesTheCsvExport) {
+    // The shipped workbook has two title rows above the header and 55 columns
+    auto columns = XLSXReader::readXLSXColumns("KV-41762_202301_test.xlsx",
+        { "hengerűrtartalom", "teljesítmény", "Elhaladási zaj [dB(A)]", "CO2 kibocsátás [g/km] (V.7.)" });
+
+    ASSERT_EQ(columns.size(), 4u);
+    ASSERT_EQ(columns[0].size(), 1394u);
+    EXPECT_EQ((Column{ columns[0][0], columns[1][0], columns[2][0], columns[3][0] }), (Column{ 1560, 85, 69, 117 }));
+    EXPECT_EQ((Column{ columns[0][1], columns[1][1], columns[2][1], columns[3][1] }), (Column{ 1968, 103, 70, 146 }));
+}
@@ -0,0 +1,113 @@
+#include "threadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t numThreads) {
+    if (numThreads == 0) {
+        numThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    m_workers.reserve(numThreads - 1);
+    for (size_t t = 1; t < numThreads; ++t) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this, t);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_jobReady.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::getNumThreads() const {
+    return m_workers.size() + 1;
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& task) {
+    parallelFor(count, [&task](size_t k, size_t) { task(k); });
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t, size_t)>& task) {
+    if (count == 0) {
+        return;
+    }
+
+    if (m_workers.empty() || count == 1) {
+        for (size_t k = 0; k < count; ++k) {
+            task(k, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_count = count;
+        m_next = 0;
+        m_busyWorkers = m_workers.size();
+        m_error = nullptr;
+        ++m_generation;
+    }
+    m_jobReady.notify_all();
+
+    runTasks(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobDone.wait(lock, [this] { return m_busyWorkers == 0; });
+    m_task = nullptr;
+
+    if (m_error) {
+        std::rethrow_exception(m_error);
+    }
+}
+
+void ThreadPool::workerLoop(size_t worker) {
+    size_t seenGeneration = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobReady.wait(lock, [&] { return m_stopping || m_generation != seenGeneration; });
+            if (m_stopping) {
+                return;
+            }
+            seenGeneration = m_generation;
+        }
+
+        runTasks(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_busyWorkers;
+        }
+        m_jobDone.notify_one();
+    }
+}
+
+void ThreadPool::runTasks(size_t worker) {
+    while (true) {
+        size_t k;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_next >= m_count || m_error) {
+                return;
+            }
+            k = m_next++;
+        }
+
+        try {
+            (*m_task)(k, worker);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_error) {
+                m_error = std::current_exception();
+            }
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that run index-parallel loops.
+// The calling thread takes part in every loop, so a pool of one thread spawns no workers.
+class ThreadPool {
+public:
+    // numThreads == 0 uses std::thread::hardware_concurrency()
+    explicit ThreadPool(size_t numThreads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t getNumThreads() const;
+
+    // Calls task(k) for every k in [0, count) and blocks until all calls returned.
+    // The first exception thrown by a task is rethrown in the caller.
+    void parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+    // Same, calling task(k, worker) with the index in [0, getNumThreads()) of the thread that
+    // runs it, so a loop can keep per-thread state in a vector of that size. The calling
+    // thread is worker 0.
+    void parallelFor(size_t count, const std::function<void(size_t, size_t)>& task);
+
+private:
+    void workerLoop(size_t worker);
+    void runTasks(size_t worker);
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_jobReady;
+    std::condition_variable m_jobDone;
+
+    const std::function<void(size_t, size_t)>* m_task = nullptr;
+    size_t m_count = 0;
+    size_t m_next = 0;
+    size_t m_busyWorkers = 0;
+    size_t m_generation = 0;
+    bool m_stopping = false;
+    std::exception_ptr m_error;
+};
+
+#endif // THREADPOOL_H
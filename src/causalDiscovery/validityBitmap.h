@@ -0,0 +1,85 @@
+#ifndef VALIDITYBITMAP_H
+#define VALIDITYBITMAP_H
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// One bit per row of a column, set where the value is present (not NaN). Rows are packed
+// 64 to a word and the bits past the last row are clear, so the rows valid in several
+// columns are the word-wise AND of their bitmaps and popcount gives their number.
+class ValidityBitmap {
+public:
+    using Word = uint64_t;
+    static constexpr size_t WordBits = 64;
+
+    ValidityBitmap() = default;
+
+    static ValidityBitmap fromColumn(std::span<const double> values) {
+        ValidityBitmap bitmap;
+        bitmap.m_numRows = values.size();
+        bitmap.m_words.assign(numWords(values.size()), 0);
+        for (size_t row = 0; row < values.size(); ++row) {
+            bitmap.m_words[row / WordBits] |= Word(!std::isnan(values[row])) << (row % WordBits);
+        }
+        return bitmap;
+    }
+
+    // Bitmap of numRows rows with none set, to be filled with setValid
+    static ValidityBitmap allClear(size_t numRows) {
+        ValidityBitmap bitmap;
+        bitmap.m_numRows = numRows;
+        bitmap.m_words.assign(numWords(numRows), 0);
+        return bitmap;
+    }
+
+    static size_t numWords(size_t numRows) {
+        return (numRows + WordBits - 1) / WordBits;
+    }
+
+    // Word w of a column without missing values
+    static Word fullWord(size_t numRows, size_t w) {
+        size_t rowsLeft = numRows - w * WordBits;
+        return rowsLeft >= WordBits ? ~Word(0) : (Word(1) << rowsLeft) - 1;
+    }
+
+    size_t getNumRows() const {
+        return m_numRows;
+    }
+
+    std::span<const Word> getWords() const {
+        return m_words;
+    }
+
+    bool isValid(size_t row) const {
+        return (m_words[row / WordBits] >> (row % WordBits)) & 1;
+    }
+
+    void setValid(size_t row) {
+        m_words[row / WordBits] |= Word(1) << (row % WordBits);
+    }
+
+    size_t countValid() const {
+        size_t count = 0;
+        for (Word word : m_words) {
+            count += std::popcount(word);
+        }
+        return count;
+    }
+
+    void andWith(const ValidityBitmap& other) {
+        // Plain word loop: compilers turn it into vector ANDs
+        for (size_t w = 0; w < m_words.size(); ++w) {
+            m_words[w] &= other.m_words[w];
+        }
+    }
+
+private:
+    std::vector<Word> m_words;
+    size_t m_numRows = 0;
+};
+
+#endif // VALIDITYBITMAP_H
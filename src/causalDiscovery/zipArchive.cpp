@@ -0,0 +1,208 @@
+#include "zipArchive.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace {
+
+constexpr uint32_t EndOfCentralDirectorySignature = 0x06054b50;
+constexpr uint32_t CentralDirectorySignature = 0x02014b50;
+constexpr uint32_t LocalHeaderSignature = 0x04034b50;
+
+constexpr size_t EndOfCentralDirectorySize = 22;
+constexpr size_t CentralDirectoryHeaderSize = 46;
+constexpr size_t LocalHeaderSize = 30;
+constexpr size_t MaxCommentSize = 0xFFFF;
+
+constexpr uint16_t MethodStored = 0;
+constexpr uint16_t MethodDeflated = 8;
+constexpr uint16_t FlagEncrypted = 0x1;
+
+// ZIP fields are little-endian and unaligned
+uint16_t read16(const char* p) {
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint16_t>(b[0] | (b[1] << 8));
+}
+
+uint32_t read32(const char* p) {
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint32_t>(b[0]) | (static_cast<uint32_t>(b[1]) << 8) | (static_cast<uint32_t>(b[2]) << 16) | (static_cast<uint32_t>(b[3]) << 24);
+}
+
+} // namespace
+
+struct ZipArchive::EntryReader::Inflater {
+    z_stream stream{};
+};
+
+ZipArchive::ZipArchive(const std::string& filename) : m_file(filename), m_filename(filename) {
+    const char* data = m_file.data();
+    size_t size = m_file.size();
+
+    if (size < EndOfCentralDirectorySize) {
+        throw std::runtime_error("Not a ZIP archive: " + filename);
+    }
+
+    // The end-of-central-directory record sits before an optional trailing comment
+    size_t searchEnd = size - EndOfCentralDirectorySize;
+    size_t searchBegin = searchEnd > MaxCommentSize ? searchEnd - MaxCommentSize : 0;
+    const char* eocd = nullptr;
+    for (size_t pos = searchEnd + 1; pos-- > searchBegin;) {
+        if (read32(data + pos) == EndOfCentralDirectorySignature) {
+            eocd = data + pos;
+            break;
+        }
+    }
+    if (!eocd) {
+        throw std::runtime_error("Not a ZIP archive: " + filename);
+    }
+
+    uint16_t numEntries = read16(eocd + 10);
+    uint32_t directorySize = read32(eocd + 12);
+    uint32_t directoryOffset = read32(eocd + 16);
+    if (numEntries == 0xFFFF || directoryOffset == 0xFFFFFFFF) {
+        throw std::runtime_error("ZIP64 archives are not supported: " + filename);
+    }
+    if (static_cast<uint64_t>(directoryOffset) + directorySize > size) {
+        throw std::runtime_error("Corrupt ZIP central directory: " + filename);
+    }
+
+    const char* record = data + directoryOffset;
+    const char* directoryEnd = record + directorySize;
+    m_entries.reserve(numEntries);
+    for (uint16_t e = 0; e < numEntries; ++e) {
+        if (directoryEnd - record < static_cast<ptrdiff_t>(CentralDirectoryHeaderSize) || read32(record) != CentralDirectorySignature) {
+            throw std::runtime_error("Corrupt ZIP central directory: " + filename);
+        }
+
+        uint16_t nameLength = read16(record + 28);
+        uint16_t extraLength = read16(record + 30);
+        uint16_t commentLength = read16(record + 32);
+        size_t recordSize = CentralDirectoryHeaderSize + nameLength + extraLength + commentLength;
+        if (directoryEnd - record < static_cast<ptrdiff_t>(recordSize)) {
+            throw std::runtime_error("Corrupt ZIP central directory: " + filename);
+        }
+        if (read16(record + 8) & FlagEncrypted) {
+            throw std::runtime_error("Encrypted ZIP entries are not supported: " + filename);
+        }
+
+        Entry entry;
+        entry.method = read16(record + 10);
+        entry.compressedSize = read32(record + 20);
+        entry.uncompressedSize = read32(record + 24);
+        entry.localHeaderOffset = read32(record + 42);
+        entry.name.assign(record + CentralDirectoryHeaderSize, nameLength);
+        if (entry.compressedSize == 0xFFFFFFFF || entry.uncompressedSize == 0xFFFFFFFF || entry.localHeaderOffset == 0xFFFFFFFF) {
+            throw std::runtime_error("ZIP64 archives are not supported: " + filename);
+        }
+
+        m_entries.push_back(std::move(entry));
+        record += recordSize;
+    }
+}
+
+const std::vector<ZipArchive::Entry>& ZipArchive::getEntries() const {
+    return m_entries;
+}
+
+const ZipArchive::Entry* ZipArchive::findEntry(const std::string& name) const {
+    auto match = std::find_if(m_entries.begin(), m_entries.end(), [&](const Entry& entry) { return entry.name == name; });
+    return match == m_entries.end() ? nullptr : &*match;
+}
+
+std::unique_ptr<ZipArchive::EntryReader> ZipArchive::open(const std::string& name) const {
+    const Entry* entry = findEntry(name);
+    if (!entry) {
+        throw std::runtime_error("Entry not found in " + m_filename + ": " + name);
+    }
+
+    const char* data = m_file.data();
+    uint64_t offset = entry->localHeaderOffset;
+    if (offset + LocalHeaderSize > m_file.size() || read32(data + offset) != LocalHeaderSignature) {
+        throw std::runtime_error("Corrupt ZIP entry: " + name);
+    }
+
+    // The local header repeats the name and may carry a different extra field
+    uint64_t payload = offset + LocalHeaderSize + read16(data + offset + 26) + read16(data + offset + 28);
+    if (payload + entry->compressedSize > m_file.size()) {
+        throw std::runtime_error("Corrupt ZIP entry: " + name);
+    }
+
+    return std::make_unique<EntryReader>(data + payload, entry->compressedSize, entry->method, name);
+}
+
+std::string ZipArchive::readEntry(const std::string& name) const {
+    auto reader = open(name);
+    std::string contents(findEntry(name)->uncompressedSize, '\0');
+
+    size_t filled = 0;
+    while (size_t count = reader->read(contents.data() + filled, contents.size() - filled)) {
+        filled += count;
+        if (filled == contents.size()) {
+            break;
+        }
+    }
+    contents.resize(filled);
+    return contents;
+}
+
+ZipArchive::EntryReader::EntryReader(const char* compressed, uint64_t compressedSize, uint16_t method, const std::string& name)
+    : m_input(compressed), m_inputSize(compressedSize), m_name(name) {
+    if (method == MethodStored) {
+        return;
+    }
+    if (method != MethodDeflated) {
+        throw std::runtime_error("Unsupported ZIP compression method " + std::to_string(method) + ": " + name);
+    }
+
+    // Raw deflate: ZIP entries carry no zlib header
+    m_inflater = std::make_unique<Inflater>();
+    if (inflateInit2(&m_inflater->stream, -MAX_WBITS) != Z_OK) {
+        throw std::runtime_error("Could not initialise the inflater for " + name);
+    }
+}
+
+ZipArchive::EntryReader::~EntryReader() {
+    if (m_inflater) {
+        inflateEnd(&m_inflater->stream);
+    }
+}
+
+size_t ZipArchive::EntryReader::read(char* buffer, size_t size) {
+    if (m_finished || size == 0) {
+        return 0;
+    }
+
+    if (!m_inflater) {
+        size_t count = static_cast<size_t>(std::min<uint64_t>(size, m_inputSize - m_inputOffset));
+        std::memcpy(buffer, m_input + m_inputOffset, count);
+        m_inputOffset += count;
+        m_finished = m_inputOffset == m_inputSize;
+        return count;
+    }
+
+    z_stream& stream = m_inflater->stream;
+    uInt capacity = static_cast<uInt>(std::min<size_t>(size, UINT_MAX));
+    stream.next_out = reinterpret_cast<Bytef*>(buffer);
+    stream.avail_out = capacity;
+
+    while (stream.avail_out == capacity && !m_finished) {
+        uInt available = static_cast<uInt>(std::min<uint64_t>(m_inputSize - m_inputOffset, UINT_MAX));
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(m_input + m_inputOffset));
+        stream.avail_in = available;
+
+        int status = inflate(&stream, Z_NO_FLUSH);
+        m_inputOffset += available - stream.avail_in;
+
+        if (status == Z_STREAM_END) {
+            m_finished = true;
+        }
+        else if (status != Z_OK || (available == 0 && stream.avail_out == capacity)) {
+            throw std::runtime_error("Corrupt or truncated ZIP entry: " + m_name);
+        }
+    }
+
+    return capacity - stream.avail_out;
+}
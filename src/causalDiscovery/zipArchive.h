@@ -0,0 +1,66 @@
+#ifndef ZIPARCHIVE_H
+#define ZIPARCHIVE_H
+
+#include "mappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Read-only access to the entries of a ZIP archive (stored or deflated, no ZIP64),
+// as used by the Office Open XML formats. The archive is memory-mapped; entries are
+// inflated incrementally, so reading one never holds more than a chunk of it in memory.
+class ZipArchive {
+public:
+    struct Entry {
+        std::string name;
+        uint16_t method = 0;
+        uint64_t compressedSize = 0;
+        uint64_t uncompressedSize = 0;
+        uint64_t localHeaderOffset = 0;
+    };
+
+    // Decompresses one entry front to back
+    class EntryReader {
+    public:
+        // compressed points at the entry's data inside the mapped archive
+        EntryReader(const char* compressed, uint64_t compressedSize, uint16_t method, const std::string& name);
+        ~EntryReader();
+
+        EntryReader(const EntryReader&) = delete;
+        EntryReader& operator=(const EntryReader&) = delete;
+
+        // Fills up to size bytes and returns how many were written; 0 at the end of the entry
+        size_t read(char* buffer, size_t size);
+
+    private:
+        struct Inflater;
+
+        const char* m_input;
+        uint64_t m_inputSize;
+        uint64_t m_inputOffset = 0;
+        std::unique_ptr<Inflater> m_inflater; // null for stored entries
+        std::string m_name;
+        bool m_finished = false;
+    };
+
+    explicit ZipArchive(const std::string& filename);
+
+    const std::vector<Entry>& getEntries() const;
+
+    // Null if the archive has no entry of that name
+    const Entry* findEntry(const std::string& name) const;
+
+    std::unique_ptr<EntryReader> open(const std::string& name) const;
+
+    // Whole entry in memory; meant for small entries such as manifests
+    std::string readEntry(const std::string& name) const;
+
+private:
+    MappedFile m_file;
+    std::string m_filename;
+    std::vector<Entry> m_entries;
+};
+
+#endif // ZIPARCHIVE_H
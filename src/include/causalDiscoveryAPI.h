@@ -1,12 +1,15 @@
 #ifndef CAUSALDISCOVERYAPI_H
 #define CAUSALDISCOVERYAPI_H
 
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <vector>
 
 class CausalDiscovery;
 class Dataset;
 class Graph;
+struct FileLoadStats;
 
 class CausalDiscoveryAPI {
 public:
@@ -16,8 +19,42 @@ public:
 
     void setAlpha(double alpha);
 
+    // Worker threads for the skeleton search; 0 uses every hardware thread
+    void setNumThreads(size_t numThreads);
+
+    // Largest conditioning set tried by the skeleton search; -1 means no cap
+    void setMaxConditioningDepth(int maxDepth);
+
+    // Off by default. When on, loading by column name keeps rows with missing or non-numeric
+    // fields as NaN instead of dropping them, and every CI test uses the rows where its own
+    // variables are all present (test-wise deletion). Set it before loading.
+    void setTestWiseDeletion(bool enabled);
+
     void loadDatasetFromFile(const std::string& filename, int numColumns = 4);
 
+    // Loads the named columns of a CSV file with a header row, or of the first worksheet of an
+    // .xlsx workbook; variable i is columnNames[i]
+    void loadDatasetFromFile(const std::string& filename, const std::vector<std::string>& columnNames);
+
+    // Loads the named columns from several files with the same schema, parsed concurrently and
+    // concatenated in order into one dataset. Entries may be wildcard patterns such as
+    // "data/KV-41762_2023*.csv"; CSV and .xlsx files can be mixed.
+    void loadDatasetFromFiles(const std::vector<std::string>& filenames, const std::vector<std::string>& columnNames);
+
+    // One record per file of the last loadDatasetFromFiles call; empty after any other load
+    const std::vector<FileLoadStats>& getLoadStats() const;
+
+    void printLoadStats() const;
+
+    // Replaces the loaded dataset by its distinct rows, each weighted by how often it occurs.
+    // p-values do not change, but every CI test then reads only the distinct rows.
+    void deduplicateRows();
+
+    // Writes the loaded dataset to a binary cache file that loadDatasetCache maps back without parsing
+    void saveDatasetCache(const std::string& filename) const;
+
+    void loadDatasetCache(const std::string& filename);
+
     void run();
 
     std::shared_ptr<Graph> getResultingGraph() const;
@@ -27,7 +64,10 @@ public:
 private:
     std::shared_ptr<CausalDiscovery> causalDiscovery_;
     double alpha_;
+    bool testWiseDeletion_;
     std::shared_ptr<Graph> graph_;
+    std::vector<std::string> columnNames_;
+    std::vector<FileLoadStats> loadStats_;
 };
 
 #endif // CAUSALDISCOVERYAPI_H
@@ -3,6 +3,7 @@
 #include "dataset.h"
 #include "causalDiscovery.h"
 #include "CSVReader.h"
+#include <random>
 
 class CausalDiscoveryTest : public ::testing::Test
 {
@@ -80,13 +81,15 @@ TEST_F(CausalDiscoveryTest, SmokeTestFCIWithLargerDataset1)
     expectedGraph->addDirectedEdge(0, 11);
 
     expectedGraph->addDirectedEdge(1, 7);
-    expectedGraph->addDirectedEdge(1, 8);
 
     expectedGraph->addDirectedEdge(2, 11);
 
     expectedGraph->addDirectedEdge(3, 8);
     expectedGraph->addDirectedEdge(3, 9);
 
+    expectedGraph->addDirectedEdge(4, 6);
+    expectedGraph->addDirectedEdge(4, 10);
+
     expectedGraph->addDirectedEdge(6, 10);
 
     expectedGraph->addDirectedEdge(8, 9);
@@ -96,6 +99,36 @@ TEST_F(CausalDiscoveryTest, SmokeTestFCIWithLargerDataset1)
     ASSERT_EQ(graph, expectedGraph) << "FCI algorithm should produce the expected graph structure";
 }
 
+TEST_F(CausalDiscoveryTest, SkeletonIsIndependentOfThreadCount)
+{
+    std::mt19937 rng(7);
+    std::normal_distribution<double> noise(0.0, 1.0);
+
+    const int numVariables = 8;
+    const int numRows = 400;
+    std::vector<Column> columns(numVariables, Column(numRows));
+    for (int r = 0; r < numRows; ++r)
+    {
+        for (int c = 0; c < numVariables; ++c)
+        {
+            columns[c][r] = noise(rng) + (c >= 2 ? 0.7 * columns[c - 1][r] + 0.3 * columns[c - 2][r] : 0.0);
+        }
+    }
+    auto data = std::make_shared<Dataset>(columns);
+
+    auto singleThreaded = std::make_shared<Graph>(data);
+    CausalDiscovery fci1;
+    fci1.setNumThreads(1);
+    fci1.runFCI(singleThreaded, 0.05);
+
+    auto multiThreaded = std::make_shared<Graph>(data);
+    CausalDiscovery fci4;
+    fci4.setNumThreads(4);
+    fci4.runFCI(multiThreaded, 0.05);
+
+    ASSERT_EQ(singleThreaded, multiThreaded) << "PC-stable skeleton must not depend on the number of threads";
+}
+
 // TODO: it fails, but shouldn't
 TEST_F(CausalDiscoveryTest, DISABLED_SmokeTestFCIWithLargerDataset2)
 {